@@ -1,4 +1,6 @@
 # measurements.py
+import csv
+import os
 import subprocess
 import matplotlib.pyplot as plt
 
@@ -20,44 +22,28 @@ parallel1d_speedups = defaultdict(list)
 parallel2d_speedups = defaultdict(list)
 
 base = "bacteria"
-serial = "_serial"
-parallel1d = "_parallel1d"
-parallel2d = "_parallel2d"
 
-graph_data = []
 
-
-for workers in nworkers:
-    simulations = []
-
-    for size in sizes:
-        in_file = f"inputs\\{base}{size}.txt"
-        simulations.append({
-            "proc": subprocess.Popen(["mpiexec", "-n", str(workers + 1), "life_mpi.exe", in_file, str(generations)]),
-            "sz": size,
-        })
-    
-    for sim in simulations:
-        sim.get("proc").communicate() # blocks until process is done
-        size = sim.get("sz")
-
-        serial_time = 0
-        parallel1d_time = 0
-        parallel2d_time = 0
-
-        with open(f"outputs\\{base}{size}\\{base}{size}{serial}.txt", "r") as f:
-            serial_time = float(f.readline())
-
-        with open(f"outputs\\{base}{size}\\{base}{size}{parallel1d}.txt", "r") as f:
-            parallel1d_time = float(f.readline())
-
-        with open(f"outputs\\{base}{size}\\{base}{size}{parallel2d}.txt", "r") as f:
-            parallel2d_time = float(f.readline())
-        
-        parallel1d_speedups[size].append(serial_time / parallel1d_time)
-        parallel2d_speedups[size].append(serial_time / parallel2d_time)
-
-        print(f"Finished size {size}:\n\t1d: {parallel1d_speedups[size][-1]}\n\t2d: {parallel2d_speedups[size][-1]}")
+# One launch per grid size: the binary sweeps over all the worker counts on sub-communicators of a single
+# `mpiexec`, so the input is parsed once and MPI start-up does not end up in the timings
+for size in sizes:
+    in_file = os.path.join("inputs", f"{base}{size}.txt")
+    sweep_file = os.path.join("outputs", f"{base}{size}", f"{base}{size}_sweep.csv")
+
+    subprocess.run([
+        "mpiexec", "-n", str(max(nworkers) + 1), "life_mpi.exe", in_file, str(generations),
+        "--sweep", ",".join(str(workers) for workers in nworkers),
+        "--sweep-out", sweep_file,
+    ], check=True)
+
+    with open(sweep_file, "r") as f:
+        for row in csv.DictReader(f):
+            if row["version"] == "parallel1d":
+                parallel1d_speedups[size].append(float(row["speedup"]))
+            elif row["version"] == "parallel2d":
+                parallel2d_speedups[size].append(float(row["speedup"]))
+
+    print(f"Finished size {size}:\n\t1d: {parallel1d_speedups[size]}\n\t2d: {parallel2d_speedups[size]}")
 
 print(parallel1d_speedups)
 print(parallel2d_speedups)
@@ -0,0 +1,66 @@
+#include "arena.h"
+#include "mem.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+
+
+arena_t* arena_create(size_t capacity) {
+    arena_t* arena = calloc(1, sizeof(arena_t));
+    if(!arena) {
+        perror("Error allocating arena");
+        exit(errno);
+    }
+
+    arena_reset(arena, capacity);
+
+    return arena;
+}
+
+
+void arena_free(arena_t* arena) {
+    if(!arena) return;
+
+    mem_free(arena->base);
+    free(arena);
+}
+
+
+void arena_reset(arena_t* arena, size_t bytes) {
+    arena->used = 0;
+
+    if(bytes <= arena->capacity) return;
+
+    mem_free(arena->base);
+
+    // Pages are touched once here, by the process that computes on them, instead of on every generation
+    size_t capacity = ARENA_SIZE(bytes);
+    arena->base = mem_alloc(capacity);
+
+    arena->capacity = capacity;
+    arena->allocs++;
+}
+
+
+void* arena_alloc(arena_t* arena, size_t bytes) {
+    size_t size = ARENA_SIZE(bytes);
+    if(arena->used + size > arena->capacity) {
+        printf("Arena out of reserved space: %zu + %zu > %zu\n", arena->used, size, arena->capacity);
+        fflush(stdout);
+        exit(-1);
+    }
+
+    void* ptr = arena->base + arena->used;
+    arena->used += size;
+
+    return ptr;
+}
+
+
+int arena_count(arena_t* arena) {
+    int allocs = arena->allocs;
+    arena->allocs = 0;
+
+    return allocs;
+}
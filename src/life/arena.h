@@ -0,0 +1,36 @@
+#ifndef _ARENA
+#define _ARENA
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Constants */
+// Cache line, so separately handed out buffers never share one
+#define ARENA_ALIGN 64
+
+/* Macros */
+// Space a buffer of `bytes` takes in the arena
+#define ARENA_SIZE(bytes) ((((size_t) (bytes)) + ARENA_ALIGN - 1) / ARENA_ALIGN * ARENA_ALIGN)
+
+/* Types */
+// Bump allocator reused for every generation of a process. It only goes to the heap when a generation needs more space than any one before it
+typedef struct _arena_t {
+    uint8_t* base;
+    size_t capacity;
+    size_t used;
+
+    int allocs; // heap allocations done since the last `arena_count(...)`
+} arena_t;
+
+/* Allocation */
+// NOTE: Do NOT forget to free the returned pointer with `arena_free(...)`
+arena_t* arena_create(size_t capacity);
+void arena_free(arena_t* arena);
+// Releases everything handed out and makes sure `bytes` (a sum of `ARENA_SIZE(...)`) fit. Contents are not kept if the arena grows
+void arena_reset(arena_t* arena, size_t bytes);
+// Hands out an aligned buffer from the space reserved by the last `arena_reset(...)`
+void* arena_alloc(arena_t* arena, size_t bytes);
+// Returns the heap allocations done since the last call, and restarts counting
+int arena_count(arena_t* arena);
+
+#endif
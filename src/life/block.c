@@ -0,0 +1,451 @@
+#include "block.h"
+
+#include <string.h>
+#include <stdint.h>
+
+
+int block_depth(area_t* jobs, int job_cnt, int tile, int time_block, int halo) {
+    if(tile == 0 || halo != BLOCK_HALO_SENDRECV) return 1;
+
+    int depth = time_block;
+    for(int i = 0; i < job_cnt; i++) {
+        int rows = jobs[i].to[1] - jobs[i].from[1] + 1;
+        int cols = jobs[i].to[0] - jobs[i].from[0] + 1;
+        depth = MIN(depth, MIN(rows, cols));
+    }
+    return depth;
+}
+
+
+void block_init(block_t* block, arena_t* arena, area_t area, int job, int job_cnt, int workers_x, int torus, int depth, int tile, int halo, int wire) {
+    int rows = area.to[1] - area.from[1] + 1;
+    int cols = area.to[0] - area.from[0] + 1;
+    int workers_y = job_cnt / workers_x;
+    int rank = job + 1;
+
+    block->rows = rows;
+    block->cols = cols;
+    block->origin[0] = area.from[0];
+    block->origin[1] = area.from[1];
+    // A tile advanced one generation per copy only adds copies to the untiled sweep
+    block->depth = depth > 1 ? depth : 1;
+    block->tile = depth > 1 ? tile : 0;
+    block->halo = halo;
+    block->wire = wire;
+
+    block->win_comm = MPI_COMM_NULL;
+    block->win = MPI_WIN_NULL;
+    block->shared_up = block->shared_down = block->shared_left = block->shared_right = NULL;
+    block->up_rows = block->left_cols = block->right_cols = 0;
+
+    // Neighbours. On a torus the blocks at opposite edges are neighbours, otherwise the universe ends there (no neighbour, dead halo)
+    int block_row = job / workers_x;
+    int block_col = job % workers_x;
+    block->up = block_row > 0 ? rank - workers_x : (torus ? rank + workers_x * (workers_y - 1) : MPI_PROC_NULL);
+    block->down = block_row < workers_y - 1 ? rank + workers_x : (torus ? rank - workers_x * (workers_y - 1) : MPI_PROC_NULL);
+
+    // 1D blocks span the whole width
+    block->wrap = workers_x == 1 && torus;
+    if(workers_x == 1) {
+        block->left = block->right = MPI_PROC_NULL;
+    }
+    else {
+        block->left = block_col > 0 ? rank - 1 : (torus ? rank + workers_x - 1 : MPI_PROC_NULL);
+        block->right = block_col < workers_x - 1 ? rank + 1 : (torus ? rank - workers_x + 1 : MPI_PROC_NULL);
+    }
+
+    // Halos are as deep as the generations between two exchanges. Where the universe ends, the ring is its padding, which stays dead
+    block->ring[0] = block->up != MPI_PROC_NULL ? block->depth : 1;
+    block->ring[1] = block->down != MPI_PROC_NULL ? block->depth : 1;
+    block->ring[2] = block->left != MPI_PROC_NULL || block->wrap ? block->depth : 1;
+    block->ring[3] = block->right != MPI_PROC_NULL || block->wrap ? block->depth : 1;
+    block->rows_real = rows + block->ring[0] + block->ring[1];
+    block->cols_real = cols + block->ring[2] + block->ring[3];
+    size_t real_size = (size_t) block->rows_real * block->cols_real;
+
+    block->packed = arena_alloc(arena, BLOCK_UNITS((size_t) rows * cols) * BLOCK_UNIT);
+    // Shared memory blocks come from their window (see `block_open(...)`)
+    block->cells = halo == BLOCK_HALO_SHM ? NULL : arena_alloc(arena, real_size * sizeof(uint8_t));
+    block->next = block->tile > 0 ? arena_alloc(arena, real_size * sizeof(uint8_t)) : NULL;
+    block->local = block->tile > 0 ? arena_alloc(arena, TILE_LOCAL(block->tile, block->depth) * sizeof(uint8_t)) : NULL;
+    block->send_wire = arena_alloc(arena, WIRE_MAX_SIZE(BLOCK_HALO_SIZE(rows, cols, block->depth)) * sizeof(uint8_t));
+    block->recv_wire = arena_alloc(arena, WIRE_MAX_SIZE(BLOCK_HALO_SIZE(rows, cols, block->depth)) * sizeof(uint8_t));
+
+    // The arena is reused, so whatever the ring held before has to go. The tiles never write the ring of their copy either
+    if(block->cells) {
+        clear_ring(block->cells, block->rows_real, block->cols_real);
+    }
+    if(block->next) {
+        clear_ring(block->next, block->rows_real, block->cols_real);
+    }
+}
+
+
+// Shared memory halos: the blocks of the node in one window, the neighbours on the node found in it
+static void block_open_shm(block_t* block, MPI_Comm comm) {
+    MPI_Win_allocate_shared((MPI_Aint) (block->rows + 2) * (block->cols + 2) * sizeof(uint8_t), sizeof(uint8_t), MPI_INFO_NULL, block->win_comm, &block->cells, &block->win);
+    clear_ring(block->cells, block->rows + 2, block->cols + 2);
+
+    // Every process reads and writes its window whenever it wants, `MPI_Win_sync(...)` orders the accesses
+    MPI_Win_lock_all(MPI_MODE_NOCHECK, block->win);
+
+    // Neighbours on the same node
+    MPI_Group group, node_group;
+    MPI_Comm_group(comm, &group);
+    MPI_Comm_group(block->win_comm, &node_group);
+
+    int neighbours[] = {block->up, block->down, block->left, block->right};
+    int node_ranks[4];
+    MPI_Group_translate_ranks(group, 4, neighbours, node_group, node_ranks);
+
+    uint8_t** shared[] = {&block->shared_up, &block->shared_down, &block->shared_left, &block->shared_right};
+    MPI_Aint sizes[4] = {0, 0, 0, 0};
+    for(int i = 0; i < 4; i++) {
+        if(node_ranks[i] == MPI_UNDEFINED || node_ranks[i] == MPI_PROC_NULL) continue;
+
+        int disp_unit;
+        MPI_Win_shared_query(block->win, node_ranks[i], &sizes[i], &disp_unit, shared[i]);
+    }
+
+    // Blocks above and below have the same columns, blocks to the sides the same rows
+    block->up_rows = block->shared_up ? sizes[0] / (block->cols + 2) - 2 : 0;
+    block->left_cols = block->shared_left ? sizes[2] / (block->rows + 2) - 2 : 0;
+    block->right_cols = block->shared_right ? sizes[3] / (block->rows + 2) - 2 : 0;
+
+    MPI_Group_free(&group);
+    MPI_Group_free(&node_group);
+}
+
+
+// Group of the given ranks of `win_comm` (`MPI_PROC_NULL` left out, each one once). `MPI_GROUP_NULL` if there are none
+static MPI_Group block_group(block_t* block, int a, int b) {
+    if(a == MPI_PROC_NULL && b == MPI_PROC_NULL) return MPI_GROUP_NULL;
+
+    int members[2];
+    int cnt = 0;
+    if(a != MPI_PROC_NULL) members[cnt++] = a;
+    if(b != MPI_PROC_NULL && b != a) members[cnt++] = b;
+
+    MPI_Group win_group, neighbours;
+    MPI_Comm_group(block->win_comm, &win_group);
+    MPI_Group_incl(win_group, cnt, members, &neighbours);
+    MPI_Group_free(&win_group);
+
+    return neighbours;
+}
+
+
+// RMA halos: every block is exposed with its ring, the neighbours learn its size to aim their puts
+static void block_open_rma(block_t* block, MPI_Comm comm) {
+    int rows = block->rows, cols = block->cols;
+
+    MPI_Win_create(block->cells, (MPI_Aint) (rows + 2) * (cols + 2) * sizeof(uint8_t), sizeof(uint8_t), MPI_INFO_NULL, block->win_comm, &block->win);
+
+    // The block below puts its first row after this block's last one, the blocks to the sides put their columns at the ends of its rows
+    MPI_Sendrecv(&rows, 1, MPI_INT, block->down, HEADER_TAG, &block->up_rows, 1, MPI_INT, block->up, HEADER_TAG, comm, MPI_STATUS_IGNORE);
+    MPI_Sendrecv(&cols, 1, MPI_INT, block->right, HEADER_TAG, &block->left_cols, 1, MPI_INT, block->left, HEADER_TAG, comm, MPI_STATUS_IGNORE);
+    MPI_Sendrecv(&cols, 1, MPI_INT, block->left, HEADER_TAG, &block->right_cols, 1, MPI_INT, block->right, HEADER_TAG, comm, MPI_STATUS_IGNORE);
+
+    // Neighbours in the window
+    MPI_Group group, win_group;
+    MPI_Comm_group(comm, &group);
+    MPI_Comm_group(block->win_comm, &win_group);
+    int neighbours[] = {block->up, block->down, block->left, block->right};
+    MPI_Group_translate_ranks(group, 4, neighbours, win_group, block->targets);
+    MPI_Group_free(&group);
+    MPI_Group_free(&win_group);
+
+    block->rows_group = block_group(block, block->targets[0], block->targets[1]);
+    block->cols_group = block_group(block, block->targets[2], block->targets[3]);
+
+    // Columns span the halo rows, same as with messages, so the corners come along
+    MPI_Type_vector(rows + 2, 1, cols + 2, MPI_UINT8_T, &block->col_type);
+    MPI_Type_vector(rows + 2, 1, block->left_cols + 2, MPI_UINT8_T, &block->left_col_type);
+    MPI_Type_vector(rows + 2, 1, block->right_cols + 2, MPI_UINT8_T, &block->right_col_type);
+    MPI_Type_commit(&block->col_type);
+    MPI_Type_commit(&block->left_col_type);
+    MPI_Type_commit(&block->right_col_type);
+}
+
+
+void block_open(block_t* block, MPI_Comm comm, int halo) {
+    if(halo == BLOCK_HALO_SENDRECV) return;
+
+    // Processes with no block are left out, so they never take part in the synchronisation
+    // Shared memory windows only span one node
+    MPI_Comm win_comm;
+    if(halo == BLOCK_HALO_SHM) {
+        MPI_Comm_split_type(comm, block ? MPI_COMM_TYPE_SHARED : MPI_UNDEFINED, 0, MPI_INFO_NULL, &win_comm);
+    }
+    else {
+        MPI_Comm_split(comm, block ? 0 : MPI_UNDEFINED, 0, &win_comm);
+    }
+    if(!block) return;
+
+    block->win_comm = win_comm;
+    if(halo == BLOCK_HALO_SHM) {
+        block_open_shm(block, comm);
+    }
+    else {
+        block_open_rma(block, comm);
+    }
+}
+
+
+void block_close(block_t* block) {
+    if(!block || block->win == MPI_WIN_NULL) return;
+
+    if(block->halo == BLOCK_HALO_SHM) {
+        MPI_Win_unlock_all(block->win);
+        // The cells go with the window
+        block->cells = NULL;
+    }
+    else {
+        if(block->rows_group != MPI_GROUP_NULL) MPI_Group_free(&block->rows_group);
+        if(block->cols_group != MPI_GROUP_NULL) MPI_Group_free(&block->cols_group);
+        MPI_Type_free(&block->col_type);
+        MPI_Type_free(&block->left_col_type);
+        MPI_Type_free(&block->right_col_type);
+    }
+    MPI_Win_free(&block->win);
+    MPI_Comm_free(&block->win_comm);
+}
+
+
+void block_pack(block_t* block, uint8_t* packed) {
+    int from[] = {block->ring[2], block->ring[0]};
+    int to[] = {block->ring[2] + block->cols - 1, block->ring[0] + block->rows - 1};
+    copy_chunk(packed, block->cells, block->rows_real, block->cols_real, from, to);
+}
+
+
+void block_unpack(block_t* block, uint8_t* packed) {
+    int from[] = {block->ring[2], block->ring[0]};
+    int to[] = {block->ring[2] + block->cols - 1, block->ring[0] + block->rows - 1};
+    place_chunk(block->cells, block->rows_real, block->cols_real, packed, from, to);
+}
+
+
+// One access epoch of the RMA halos with the neighbours in `group`: they put into this block while it puts into them
+static void block_epoch(block_t* block, MPI_Group group, int begin) {
+    if(group == MPI_GROUP_NULL) return;
+
+    if(begin) {
+        MPI_Win_post(group, 0, block->win);
+        MPI_Win_start(group, 0, block->win);
+    }
+    else {
+        MPI_Win_complete(block->win);
+        MPI_Win_wait(block->win);
+    }
+}
+
+
+// RMA halos: each edge is put straight from the block into the ring of the neighbour, columns included (vector types on both ends)
+static void block_exchange_rma(block_t* block) {
+    int rows = block->rows, cols = block->cols;
+    uint8_t* cells = block->cells;
+
+    block_epoch(block, block->rows_group, 1);
+    if(block->up != MPI_PROC_NULL) {
+        MPI_Put(cells + (cols + 2) + 1, cols, MPI_UINT8_T, block->targets[0], (MPI_Aint) (block->up_rows + 1) * (cols + 2) + 1, cols, MPI_UINT8_T, block->win);
+    }
+    if(block->down != MPI_PROC_NULL) {
+        MPI_Put(cells + (size_t) rows * (cols + 2) + 1, cols, MPI_UINT8_T, block->targets[1], 1, cols, MPI_UINT8_T, block->win);
+    }
+    block_epoch(block, block->rows_group, 0);
+
+    if(block->wrap) {
+        wrap_cols(cells, rows + 2, cols + 2);
+        return;
+    }
+
+    // After the rows, so the halo rows (and their corners) go along with the columns
+    block_epoch(block, block->cols_group, 1);
+    if(block->left != MPI_PROC_NULL) {
+        MPI_Put(cells + 1, 1, block->col_type, block->targets[2], block->left_cols + 1, 1, block->left_col_type, block->win);
+    }
+    if(block->right != MPI_PROC_NULL) {
+        MPI_Put(cells + cols, 1, block->col_type, block->targets[3], 0, 1, block->right_col_type, block->win);
+    }
+    block_epoch(block, block->cols_group, 0);
+}
+
+
+// Shared memory halos: waits until the blocks of the node are done with everything before this point
+static void block_sync(block_t* block) {
+    if(block->win == MPI_WIN_NULL) return;
+
+    MPI_Win_sync(block->win);
+    MPI_Barrier(block->win_comm);
+    MPI_Win_sync(block->win);
+}
+
+
+// One halo message: `count` cells `stride` apart go from `src` to `dest`, as many come from `source` into `dst`, in the wire format of the block
+// Raw rows are contiguous, so they go straight from and into the block
+static void block_halo(block_t* block, MPI_Comm comm, uint8_t* src, uint8_t* dst, int count, int stride, int dest, int source) {
+    if(block->wire == WIRE_RAW && stride == 1) {
+        MPI_Sendrecv(src, count, MPI_UINT8_T, dest, DATA_TAG,
+                    dst, count, MPI_UINT8_T, source, DATA_TAG,
+                    comm, MPI_STATUS_IGNORE);
+        return;
+    }
+
+    int bytes = dest != MPI_PROC_NULL ? wire_encode(block->wire, src, count, stride, block->send_wire) : 0;
+
+    // Run-length encoded halos vary in length, the receiver finds out from the status
+    MPI_Status status;
+    MPI_Sendrecv(block->send_wire, bytes, MPI_UINT8_T, dest, DATA_TAG,
+                block->recv_wire, WIRE_MAX_SIZE(count), MPI_UINT8_T, source, DATA_TAG,
+                comm, &status);
+
+    if(source != MPI_PROC_NULL) {
+        int received = 0;
+        MPI_Get_count(&status, MPI_UINT8_T, &received);
+        wire_decode(block->wire, block->recv_wire, received, count, dst, stride, CELL_ALIVE);
+    }
+}
+
+
+// Fills the ring of the block with the edges of its neighbours. Edges with no neighbour are left as they are (dead)
+// Neighbours on the same node are read straight from their blocks, messages only go to the others (`MPI_PROC_NULL` stands in for the rest)
+static void block_exchange(block_t* block, MPI_Comm comm) {
+    if(block->halo == BLOCK_HALO_RMA) {
+        block_exchange_rma(block);
+        return;
+    }
+
+    int rows = block->rows, cols = block->cols;
+    uint8_t* cells = block->cells;
+    int up = block->shared_up ? MPI_PROC_NULL : block->up;
+    int down = block->shared_down ? MPI_PROC_NULL : block->down;
+    int left = block->shared_left ? MPI_PROC_NULL : block->left;
+    int right = block->shared_right ? MPI_PROC_NULL : block->right;
+
+    block_sync(block); // Edges of the neighbours
+
+    // Halo up - Send up, receive down
+    block_halo(block, comm, cells + (cols + 2) + 1, cells + (size_t) (rows + 1) * (cols + 2) + 1, cols, 1, up, down);
+    if(block->shared_down) {
+        memcpy(cells + (size_t) (rows + 1) * (cols + 2) + 1, block->shared_down + (cols + 2) + 1, cols * sizeof(uint8_t));
+    }
+
+    // Halo down - Send down, receive up
+    block_halo(block, comm, cells + (size_t) rows * (cols + 2) + 1, cells + 1, cols, 1, down, up);
+    if(block->shared_up) {
+        memcpy(cells + 1, block->shared_up + (size_t) block->up_rows * (cols + 2) + 1, cols * sizeof(uint8_t));
+    }
+
+    if(block->wrap) {
+        wrap_cols(cells, rows + 2, cols + 2);
+        return;
+    }
+    if(block->left == MPI_PROC_NULL && block->right == MPI_PROC_NULL) return;
+
+    block_sync(block); // Halo rows of the neighbours, they hold the corners
+
+    // Halo left - Send left, receive right. Columns are strided, so they go through the staging buffers
+    // Columns go after the rows and span the halo rows too, which brings the diagonal corners (needed by Moore rules) along without extra messages
+    block_halo(block, comm, cells + 1, cells + cols + 1, rows + 2, cols + 2, left, right);
+    if(block->shared_right) {
+        for(int i = 0; i < rows + 2; i++) {
+            cells[(size_t) i * (cols + 2) + cols + 1] = block->shared_right[(size_t) i * (block->right_cols + 2) + 1];
+        }
+    }
+
+    // Halo right - Send right, receive left
+    block_halo(block, comm, cells + cols, cells, rows + 2, cols + 2, right, left);
+    if(block->shared_left) {
+        for(int i = 0; i < rows + 2; i++) {
+            cells[(size_t) i * (cols + 2)] = block->shared_left[(size_t) i * (block->left_cols + 2) + block->left_cols];
+        }
+    }
+}
+
+
+// Tiled blocks: fills the ring with the `depth` rows and columns next to the edges of the neighbours, messages only
+// Rows go first, whole rows of the ring at once, then the columns one by one over all the rows, which brings the corners of the diagonal neighbours along
+static void block_exchange_deep(block_t* block, MPI_Comm comm) {
+    int rows = block->rows, cols = block->cols;
+    int cols_real = block->cols_real;
+    int depth = block->depth;
+    int* ring = block->ring;
+    uint8_t* cells = block->cells;
+
+    // Halo up - Send up, receive down
+    block_halo(block, comm, cells + (size_t) ring[0] * cols_real, cells + (size_t) (ring[0] + rows) * cols_real, depth * cols_real, 1, block->up, block->down);
+    // Halo down - Send down, receive up
+    block_halo(block, comm, cells + (size_t) (ring[0] + rows - depth) * cols_real, cells, depth * cols_real, 1, block->down, block->up);
+
+    if(block->wrap) {
+        for(int i = 0; i < block->rows_real; i++) {
+            uint8_t* row = cells + (size_t) i * cols_real;
+            memcpy(row, row + cols, depth * sizeof(uint8_t));
+            memcpy(row + depth + cols, row + depth, depth * sizeof(uint8_t));
+        }
+        return;
+    }
+    if(block->left == MPI_PROC_NULL && block->right == MPI_PROC_NULL) return;
+
+    for(int c = 0; c < depth; c++) {
+        // Halo left - Send left, receive right
+        block_halo(block, comm, cells + ring[2] + c, cells + ring[2] + cols + c, block->rows_real, cols_real, block->left, block->right);
+        // Halo right - Send right, receive left
+        block_halo(block, comm, cells + ring[2] + cols - depth + c, cells + c, block->rows_real, cols_real, block->right, block->left);
+    }
+}
+
+
+void block_refresh(block_t* block, MPI_Comm comm) {
+    // Tiled blocks exchange and update their whole ring at the start of every step anyway
+    if(block->tile > 0) return;
+
+    clear_ring(block->cells, block->rows + 2, block->cols + 2);
+    block_exchange(block, comm);
+    updater(block->cells, block->rows + 2, block->cols + 2);
+
+    block_sync(block); // Neighbours are done reading the block
+}
+
+
+void block_step(block_t* block, MPI_Comm comm, int gens, uint64_t* deltas, gen_stats_t* stats, dmap_t* map, int map_gen) {
+    int rows_real = block->rows_real, cols_real = block->cols_real;
+    int ring_origin[] = {block->origin[0] - block->ring[2], block->origin[1] - block->ring[0]};
+    uint64_t delta = 0;
+
+    if(block->tile > 0) {
+        // The halos replace those of the last step, then the updater gives the ring and the edges of the block their neighbour data
+        block_exchange_deep(block, comm);
+        updater(block->cells, rows_real, cols_real);
+
+        tile_gens(block->cells, rows_real, cols_real, block->ring, block->next, gens, block->tile, block->local, ring_origin, deltas, stats, map, map_gen);
+        swapp((void**) &block->cells, (void**) &block->next);
+        return;
+    }
+
+    block_sync(block); // Neighbours are done reading the last generation
+
+    // The ring still holds the halos of the last generation. Dead, it is solved along with the block without flipping
+    clear_ring(block->cells, rows_real, cols_real);
+
+    if(stats) {
+        delta = ssolver(block->cells, rows_real, cols_real, ring_origin, stats, map);
+    }
+    else if(map) {
+        delta = msolver(block->cells, rows_real, cols_real, ring_origin, deltas != NULL, map);
+    }
+    else if(deltas) {
+        delta = hsolver(block->cells, rows_real, cols_real, ring_origin);
+    }
+    else {
+        solver(block->cells, rows_real, cols_real);
+    }
+
+    block_exchange(block, comm);
+    updater(block->cells, rows_real, cols_real);
+
+    if(deltas) {
+        deltas[0] = delta;
+    }
+}
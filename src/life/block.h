@@ -0,0 +1,113 @@
+#ifndef _BLOCK
+#define _BLOCK
+
+#include <stdint.h>
+#include <mpi.h>
+
+#include "life.h"
+#include "tile.h"
+#include "wire.h"
+
+/* Constants */
+// How the halos travel between neighbours (`--halo`)
+#define BLOCK_HALO_SENDRECV 0 // one `MPI_Sendrecv(...)` per direction
+#define BLOCK_HALO_SHM      1 // blocks of the same node live in one shared window and are read directly, `MPI_Sendrecv(...)` between nodes
+#define BLOCK_HALO_RMA      2 // every block is a window, neighbours `MPI_Put(...)` their edges into its ring (post-start-complete-wait)
+
+// Blocks are scattered and gathered in units of this many bytes, so the `int` counts of the collectives reach far past 2 GB
+#define BLOCK_UNIT 4096
+
+/* Macros */
+// Units of a message of `bytes` bytes, the last one padded
+#define BLOCK_UNITS(bytes) (((size_t) (bytes) + BLOCK_UNIT - 1) / BLOCK_UNIT)
+// Cells of a `rows` x `cols` block inside a ring `depth` cells deep
+#define BLOCK_REAL_SIZE(rows, cols, depth) ((size_t) ((rows) + 2 * (depth)) * ((cols) + 2 * (depth)))
+// Cells of the longest halo message of a block with a ring `depth` cells deep: `depth` whole rows, or a column
+#define BLOCK_HALO_SIZE(rows, cols, depth) MAX((size_t) (depth) * ((cols) + 2 * (depth)), (size_t) (rows) + 2 * (depth))
+// Arena space a `rows` x `cols` block needs (see `block_init(...)`). Tiled blocks (`tile` > 0) take a second copy of the block and the scratch space of a tile
+#define BLOCK_ARENA_SIZE(rows, cols, depth, tile) (ARENA_SIZE(BLOCK_UNITS((size_t) (rows) * (cols)) * BLOCK_UNIT) + ((tile) > 0 ? 2 : 1) * ARENA_SIZE(BLOCK_REAL_SIZE(rows, cols, depth)) + 2 * ARENA_SIZE(WIRE_MAX_SIZE(BLOCK_HALO_SIZE(rows, cols, depth))) + ((tile) > 0 ? ARENA_SIZE(TILE_LOCAL(tile, depth)) : 0))
+// First cell of the block in `cells`, rows `cols_real` apart
+#define BLOCK_FIRST(block) ((block)->cells + (size_t) (block)->ring[0] * (block)->cols_real + (block)->ring[2])
+
+/* Types */
+// Block of the universe that stays on its worker for a whole run. Only the halos travel between generations
+typedef struct _block_t {
+    int rows, cols; // without the halo ring
+    int origin[2]; // position of the block's first cell in the padded universe (x, y)
+    // Generations per halo exchange, and how deep the ring is up, down, left and right: `depth` where a neighbour's halo goes, 1 where the universe ends (its dead padding)
+    int depth;
+    int ring[4];
+    int rows_real, cols_real; // with the ring
+    int tile; // side of the tiles the block is advanced in, 0 if it is not tiled
+
+    // Neighbour ranks, `MPI_PROC_NULL` where the universe ends (dead halo)
+    int up, down, left, right;
+    int wrap; // 1D block of a torus: spans the whole width, so its side halos are its own opposite columns
+
+    int halo;
+    int wire; // format of the halo messages (see wire.h)
+    // Window halos: the processes of the window (the workers of the node for shared memory, all the workers with a block for RMA) and the window the blocks live in
+    MPI_Comm win_comm;
+    MPI_Win win;
+    int up_rows; // rows of the block above, its last row is the halo
+    int left_cols; // columns of the blocks to the sides, their row length
+    int right_cols;
+    // Shared memory halos: the blocks of the neighbours on the same node, NULL otherwise
+    uint8_t* shared_up;
+    uint8_t* shared_down;
+    uint8_t* shared_left;
+    uint8_t* shared_right;
+    // RMA halos: the neighbours in `win_comm` (up, down, left, right), the neighbours of each exchange and the columns of this block and of the blocks to the sides
+    int targets[4];
+    MPI_Group rows_group;
+    MPI_Group cols_group;
+    MPI_Datatype col_type;
+    MPI_Datatype left_col_type;
+    MPI_Datatype right_col_type;
+
+    uint8_t* cells; // `rows_real * cols_real`, the block inside its halo ring
+    uint8_t* packed; // `rows * cols`, the block alone, for transfers. Padded to whole `BLOCK_UNIT`s
+    uint8_t* send_wire; // encoded halos, `WIRE_MAX_SIZE(...)` of the longest one
+    uint8_t* recv_wire;
+    // Tiled blocks: the copy the tiles are written into, swapped with `cells` after every step, and the local copy of a tile
+    uint8_t* next;
+    uint8_t* local;
+} block_t;
+
+/* Blocks */
+// Generations the blocks of `jobs` can be advanced per halo exchange when tiled, at most `time_block`: the halos of a block come from the edges of its neighbours, so no block may be thinner than its ring
+// Blocks whose halos are not messages (shared memory, RMA) and blocks that could not go 2 generations are not tiled, 1
+int block_depth(area_t* jobs, int job_cnt, int tile, int time_block, int halo);
+// Sets up the `job`-th block of a layout `workers_x` blocks wide, worked on by rank `job + 1`, with buffers from `arena`. It is advanced in `tile` x `tile` tiles, `depth` generations per halo exchange, when `depth` > 1
+// The arena has to be reset with at least `BLOCK_ARENA_SIZE(...)` before. The ring starts dead
+void block_init(block_t* block, arena_t* arena, area_t area, int job, int job_cnt, int workers_x, int torus, int depth, int tile, int halo, int wire);
+// Sets up the `halo` exchange of the run, collectively over `comm`: every process of `comm` calls it, with a NULL `block` if it has none (the master, idle workers)
+// NOTE: Do NOT forget to call `block_close(...)` the same way at the end of the run
+void block_open(block_t* block, MPI_Comm comm, int halo);
+void block_close(block_t* block);
+// Copies the block without its ring into / out of `packed` (`rows * cols` cells)
+void block_pack(block_t* block, uint8_t* packed);
+void block_unpack(block_t* block, uint8_t* packed);
+// Rebuilds the neighbour data of a block that only got its alive bits (a block sent as bits), exchanging the alive bits of the edges first
+void block_refresh(block_t* block, MPI_Comm comm);
+// Advances the block `gens` generations (at most `depth`), exchanging the halos with its neighbours through `comm`
+/*
+    Args:
+        block_t*: block to advance
+        MPI_Comm: communicator of the workers
+        int: generations to advance, 1 unless the block is tiled
+        uint64_t*: hash delta of the block for each of the `gens` generations. Can be NULL
+        gen_stats_t*: statistics of the block added to each of the `gens` generations (see `ssolver(...)`). Can be NULL
+        dmap_t*: map the alive cells of the block are added to. Can be NULL
+        int: generation of the call after which they are counted into the map, from 1
+    **NOTE:**:
+        - Untiled, the block is solved first and the halos carry the solved cells the updater needs, one cell deep, every generation
+        - Tiled, the halos are exchanged once per step, `depth` cells deep, and carry the cells before it. The whole ring is updated, then the block is advanced in `tile` x `tile` tiles that stay in cache for all the `gens` generations (see `tile_gens(...)`) and written into the second copy of the block. Wrong values only come in from the outer edge of the ring, one cell per generation, so they never reach the block
+        - Neighbours only wait for each other, so there is no barrier between generations. Shared memory halos synchronise the workers of a node instead (`MPI_Win_sync(...)` and a barrier of the node), before the halos are read and before a block read by its neighbours changes
+        - Messages carry the cells in the block's `wire` format, bits being the alive bits. Direct copies and puts (shared memory, RMA) move the cell bytes
+        - RMA halos take two access epochs, rows then columns, each only with the neighbours of that exchange
+        - Statistics and the map are counted in the solver's pass untiled, and by the tiles while they are in cache otherwise
+*/
+void block_step(block_t* block, MPI_Comm comm, int gens, uint64_t* deltas, gen_stats_t* stats, dmap_t* map, int map_gen);
+
+#endif
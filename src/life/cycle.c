@@ -0,0 +1,75 @@
+#include "cycle.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <stdint.h>
+
+
+cycle_t* cycle_create(int window) {
+    cycle_t* cycle = calloc(1, sizeof(cycle_t));
+    if(!cycle) {
+        perror("Error allocating cycle detector");
+        exit(errno);
+    }
+
+    cycle->window = window;
+    cycle->hashes = calloc(window, sizeof(uint64_t));
+    cycle->gens = calloc(window, sizeof(int));
+    if(!cycle->hashes || !cycle->gens) {
+        perror("Error allocating cycle history");
+        exit(errno);
+    }
+
+    return cycle;
+}
+
+
+void cycle_free(cycle_t* cycle) {
+    if(!cycle) return;
+
+    free(cycle->hashes);
+    free(cycle->gens);
+    free(cycle);
+}
+
+
+int cycle_push(cycle_t* cycle, int gen, uint64_t hash) {
+    // Only the first repetition is kept
+    if(!cycle->period) {
+        for(int i = 0; i < cycle->len; i++) {
+            int idx = (cycle->head - 1 - i + cycle->window) % cycle->window;
+            if(cycle->hashes[idx] == hash) {
+                cycle->period = gen - cycle->gens[idx];
+                cycle->found_gen = gen;
+                cycle->found_hash = hash;
+                break;
+            }
+        }
+    }
+
+    cycle->hashes[cycle->head] = hash;
+    cycle->gens[cycle->head] = gen;
+    cycle->head = (cycle->head + 1) % cycle->window;
+    if(cycle->len < cycle->window) cycle->len++;
+
+    return cycle->period;
+}
+
+
+void cycle_report(cycle_t* cycle, int gens_done) {
+    if(!cycle || !cycle->period) return;
+
+    // The hash of the empty universe is 0
+    if(cycle->found_hash == 0) {
+        printf("* Extinction at generation %d\n", cycle->found_gen - cycle->period);
+    }
+    else if(cycle->period == 1) {
+        printf("* Still life reached at generation %d\n", cycle->found_gen - 1);
+    }
+    else {
+        printf("* Oscillation with period %d detected at generation %d\n", cycle->period, cycle->found_gen);
+    }
+    printf("* Stopped after %d generations\n", gens_done);
+    fflush(stdout);
+}
@@ -0,0 +1,32 @@
+#ifndef _CYCLE
+#define _CYCLE
+
+#include <stdint.h>
+
+/* Constants */
+#define CYCLE_DEFAULT_CHECK 4
+
+/* Types */
+// History of the last global hashes of a run. Detects when the state repeats itself
+typedef struct _cycle_t {
+    int window; // largest period that can be detected
+    uint64_t* hashes; // ring buffer of the last `window` hashes
+    int* gens; // generation of each stored hash
+    int len;
+    int head;
+
+    int period; // 0 until a repetition is found
+    int found_gen; // first generation that repeated an older one
+    uint64_t found_hash;
+} cycle_t;
+
+/* Detection */
+// NOTE: Do NOT forget to free the returned pointer with `cycle_free(...)`
+cycle_t* cycle_create(int window);
+void cycle_free(cycle_t* cycle);
+// Adds the hash of generation `gen`. Returns the detected period (0 if the state did not repeat in the window)
+int cycle_push(cycle_t* cycle, int gen, uint64_t hash);
+// Prints what was detected and after how many generations the run stopped
+void cycle_report(cycle_t* cycle, int gens_done);
+
+#endif
@@ -0,0 +1,95 @@
+#include "dmap.h"
+#include "life.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+
+void dmap_init(dmap_t* map, int rows, int cols, int side, uint32_t* counts) {
+    map->rows = rows;
+    map->cols = cols;
+    map->side = side;
+    map->map_rows = DMAP_BLOCKS(rows, side);
+    map->map_cols = DMAP_BLOCKS(cols, side);
+    map->first_row = map->first_col = 0;
+    map->counts = counts;
+}
+
+
+void dmap_init_part(dmap_t* map, int rows, int cols, int side, int* from, int* to, uint32_t* counts) {
+    map->rows = rows;
+    map->cols = cols;
+    map->side = side;
+    map->map_rows = DMAP_SPAN(from[1], to[1], side);
+    map->map_cols = DMAP_SPAN(from[0], to[0], side);
+    map->first_row = (from[1] - 1) / side;
+    map->first_col = (from[0] - 1) / side;
+    map->counts = counts;
+}
+
+
+void dmap_clear(dmap_t* map) {
+    memset(map->counts, 0, (size_t) map->map_rows * map->map_cols * sizeof(uint32_t));
+}
+
+
+void dmap_row(dmap_t* map, const uint8_t* cells, int y, int x, int n) {
+    int block_row = (y - 1) / map->side - map->first_row;
+    if(y < 1 || y > map->rows || block_row < 0 || block_row >= map->map_rows) return;
+
+    uint32_t* line = map->counts + (size_t) block_row * map->map_cols;
+    int to = MIN(x + n - 1, MIN(map->cols, (map->first_col + map->map_cols) * map->side));
+
+    // One run of cells per block crossed, so the counters are only touched once per block
+    for(int from = MAX(x, MAX(1, map->first_col * map->side + 1)); from <= to;) {
+        int block = (from - 1) / map->side;
+        int end = MIN(to, (block + 1) * map->side);
+
+        uint32_t alive = 0;
+        for(int j = from; j <= end; j++) {
+            alive += IS_ALIVE(cells[j - x]);
+        }
+        line[block - map->first_col] += alive;
+        from = end + 1;
+    }
+}
+
+
+void dmap_add(dmap_t* map, const dmap_t* part) {
+    for(int i = 0; i < part->map_rows; i++) {
+        uint32_t* line = map->counts + (size_t) (part->first_row - map->first_row + i) * map->map_cols + (part->first_col - map->first_col);
+        for(int j = 0; j < part->map_cols; j++) {
+            line[j] += part->counts[(size_t) i * part->map_cols + j];
+        }
+    }
+}
+
+
+void dmap_count(dmap_t* map, const uint8_t* cells, int rows, int cols, int row_len, int* start) {
+    for(int i = 0; i < rows; i++) {
+        dmap_row(map, cells + (size_t) i * row_len, start[1] + i, start[0], cols);
+    }
+}
+
+
+void dmap_write(dmap_t* map, FILE* out_file, int gen) {
+    uint8_t pixels[map->map_cols];
+
+    fprintf(out_file, "P5\n# generation %d\n%d %d\n255\n", gen, map->map_cols, map->map_rows);
+    for(int i = 0; i < map->map_rows; i++) {
+        int height = MIN(map->side, map->rows - i * map->side);
+
+        for(int j = 0; j < map->map_cols; j++) {
+            int width = MIN(map->side, map->cols - j * map->side);
+            uint64_t cells = (uint64_t) height * width;
+            pixels[j] = (map->counts[(size_t) i * map->map_cols + j] * 255ULL + cells / 2) / cells;
+        }
+
+        if(fwrite(pixels, sizeof(uint8_t), map->map_cols, out_file) != (size_t) map->map_cols) {
+            perror("Error while writing density map");
+            exit(errno);
+        }
+    }
+    fflush(out_file);
+}
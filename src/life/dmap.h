@@ -0,0 +1,51 @@
+#ifndef _DMAP
+#define _DMAP
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+
+/* Constants */
+// Generations between two frames, when `--map-every` is not given
+#define DMAP_DEFAULT_EVERY 16
+
+/* Macros */
+// Blocks of a coarse map of `side * side` cells over `n` cells
+#define DMAP_BLOCKS(n, side) (((n) + (side) - 1) / (side))
+// Bytes of the counts of a map over a `rows * cols` universe
+#define DMAP_SIZE(rows, cols, side) ((size_t) DMAP_BLOCKS(rows, side) * DMAP_BLOCKS(cols, side) * sizeof(uint32_t))
+// Blocks of a map crossed by the padded positions `from` to `to` of one dimension (from 1)
+#define DMAP_SPAN(from, to, side) (((to) - 1) / (side) - ((from) - 1) / (side) + 1)
+// Blocks of a map crossed by the cells from `from` to `to` (int[2] x, y, padded universe)
+#define DMAP_PART_BLOCKS(from, to, side) ((size_t) DMAP_SPAN((from)[1], (to)[1], side) * DMAP_SPAN((from)[0], (to)[0], side))
+
+/* Types */
+// Alive cells of every `side * side` block of a universe (the last row and column of blocks may be smaller), or of the blocks a part of it crosses
+typedef struct _dmap_t {
+    int rows, cols; // universe, without padding
+    int side;
+    int map_rows, map_cols; // blocks counted
+    int first_row, first_col; // first block counted, 0 unless the map only covers a part of the universe
+    uint32_t* counts; // `map_rows * map_cols`, row by row, not owned
+} dmap_t;
+
+/* Density map */
+// Map over a `rows * cols` universe, counting into `counts` (`DMAP_SIZE(rows, cols, side)` bytes). Does not clear it
+void dmap_init(dmap_t* map, int rows, int cols, int side, uint32_t* counts);
+// Same, only over the blocks crossed by the cells from `from` to `to` (int[2] x, y, padded universe, inside it), counting into `counts` (`DMAP_SPAN(...)` blocks each way)
+void dmap_init_part(dmap_t* map, int rows, int cols, int side, int* from, int* to, uint32_t* counts);
+void dmap_clear(dmap_t* map);
+// Adds the alive cells of the `n` cells of padded row `y` starting at padded column `x`. Cells of the padding ring, and outside the blocks of a part, are left out
+void dmap_row(dmap_t* map, const uint8_t* cells, int y, int x, int n);
+// Adds the counts of `part` (same universe and side) to its blocks of `map`
+void dmap_add(dmap_t* map, const dmap_t* part);
+// Adds the alive cells of a chunk of `rows * cols` cells, `row_len` apart, whose first cell is (`start[0]`, `start[1]`) in the padded universe, in a pass of its own
+void dmap_count(dmap_t* map, const uint8_t* cells, int rows, int cols, int row_len, int* start);
+// Appends the map as a binary PGM frame (P5): the live fraction of each block, from 0 (black) to 255
+/*
+    **NOTE:**:
+        - Frames follow each other in the same stream without separators, as `ffmpeg -f image2pipe -c:v pgm` and the netpbm tools read them. The generation goes in a header comment
+*/
+void dmap_write(dmap_t* map, FILE* out_file, int gen);
+
+#endif
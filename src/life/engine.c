@@ -0,0 +1,223 @@
+#include "engine.h"
+#include "life.h"
+#include "rule.h"
+#include "mem.h"
+#include "tile.h"
+#include "frontier.h"
+#include "sched.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+struct _engine_t {
+    int rows, cols; // padded universe
+    int torus;
+    char rule[32]; // canonical name, to switch back to it
+
+    uint8_t* cells;
+    uint64_t hash;
+    long long gen;
+
+    // Temporal blocking (`tile > 0`): a second universe, the local copy of one tile and the deltas of a block of generations
+    int tile, time_block;
+    uint8_t* next;
+    uint8_t* local;
+    uint64_t* deltas;
+
+    frontier_t* frontier;
+    sched_t* sched;
+};
+
+
+// Makes the rule of the engine the rule of the process, if it is not already
+static void engine_use_rule(engine_t* engine) {
+    if(strcmp(rule_get()->name, engine->rule) != 0) {
+        rule_set(engine->rule);
+    }
+}
+
+
+// Engine around a padded universe whose alive bits are set. Takes `cells` over. Returns NULL (freeing `cells`) if the rule cannot be parsed or something does not fit in memory
+static engine_t* engine_wrap(uint8_t* cells, int rows, int columns, const engine_config_t* config) {
+    engine_config_t defaults = {0};
+    if(!config) config = &defaults;
+
+    if(!cells || rule_set(config->rule ? config->rule : RULE_DEFAULT) != 0) {
+        mem_free(cells);
+        return NULL;
+    }
+
+    // Zeroed, so `engine_free(...)` can take apart an engine that could not be built
+    engine_t* engine = calloc(1, sizeof(engine_t));
+    if(!engine) {
+        mem_free(cells);
+        return NULL;
+    }
+
+    engine->rows = rows + 2;
+    engine->cols = columns + 2;
+    engine->torus = config->torus;
+    snprintf(engine->rule, sizeof(engine->rule), "%s", rule_get()->name);
+
+    // Neighbour data for the rule and the boundaries, as the MPI driver prepares a loaded universe
+    engine->cells = cells;
+    if(engine->torus) {
+        wrap_ring(cells, engine->rows, engine->cols);
+    }
+    updater(cells, engine->rows, engine->cols);
+    if(engine->torus) {
+        clear_ring(cells, engine->rows, engine->cols);
+    }
+
+    int start[] = {0, 0};
+    engine->hash = ghash(cells, engine->rows, engine->cols, start);
+    engine->gen = 0;
+
+    if(config->frontier > 0) {
+        engine->frontier = frontier_create(engine->rows, engine->cols, engine->torus, config->frontier);
+        if(!engine->frontier) {
+            engine_free(engine);
+            return NULL;
+        }
+    }
+    else if(config->threads > 0) {
+        engine->sched = sched_create(engine->rows, engine->cols, engine->torus, config->tile > 0 ? config->tile : SCHED_DEFAULT_TILE, config->threads);
+        if(!engine->sched) {
+            engine_free(engine);
+            return NULL;
+        }
+    }
+
+    // The ring of a torus only holds the opposite edges for one generation, so a torus runs untiled
+    engine->tile = !engine->frontier && !engine->sched && !engine->torus ? config->tile : 0;
+    engine->time_block = config->time_block > 0 ? config->time_block : TILE_DEFAULT_DEPTH;
+    if(engine->tile > 0) {
+        engine->next = mem_try_alloc((size_t) engine->rows * engine->cols * sizeof(uint8_t));
+        engine->local = mem_try_alloc(TILE_LOCAL(engine->tile, engine->time_block) * sizeof(uint8_t));
+    }
+    if(engine->tile > 0 || engine->sched) {
+        engine->deltas = malloc(engine->time_block * sizeof(uint64_t));
+    }
+    if((engine->tile > 0 && (!engine->next || !engine->local)) || ((engine->tile > 0 || engine->sched) && !engine->deltas)) {
+        engine_free(engine);
+        return NULL;
+    }
+
+    return engine;
+}
+
+
+engine_t* engine_create(const uint8_t* cells, int rows, int columns, const engine_config_t* config) {
+    size_t cols_real = columns + 2;
+    uint8_t* buffer = rows > 0 && columns > 0 ? mem_try_alloc((size_t) (rows + 2) * cols_real * sizeof(uint8_t)) : NULL;
+    if(!buffer) return NULL;
+
+    for(int i = 0; i < rows; i++) {
+        for(int j = 0; j < columns; j++) {
+            buffer[(i + 1) * cols_real + j + 1] = cells[(size_t) i * columns + j] ? CELL_ALIVE : 0;
+        }
+    }
+
+    return engine_wrap(buffer, rows, columns, config);
+}
+
+
+engine_t* engine_load(char* path, const engine_config_t* config) {
+    int rows = 0, columns = 0;
+    uint8_t* buffer = fparse_gen(path, &rows, &columns);
+
+    return engine_wrap(buffer, rows, columns, config);
+}
+
+
+void engine_free(engine_t* engine) {
+    if(!engine) return;
+
+    mem_free(engine->cells);
+    mem_free(engine->next);
+    mem_free(engine->local);
+    free(engine->deltas);
+    frontier_free(engine->frontier);
+    sched_free(engine->sched);
+    free(engine);
+}
+
+
+int engine_step(engine_t* engine, int gens) {
+    engine_use_rule(engine);
+
+    int origin[] = {0, 0};
+    for(int gen = 0; gen < gens;) {
+        if(engine->tile > 0) {
+            int steps = MIN(engine->time_block, gens - gen);
+            tile_gens(engine->cells, engine->rows, engine->cols, NULL, engine->next, steps, engine->tile, engine->local, origin, engine->deltas, NULL, NULL, 0);
+            swapp((void**) &engine->cells, (void**) &engine->next);
+
+            for(int step = 0; step < steps; step++) {
+                engine->hash ^= engine->deltas[step];
+            }
+            gen += steps;
+        }
+        else if(engine->sched) {
+            // The pool stops once per block of generations, to hand back their deltas
+            int steps = MIN(engine->time_block, gens - gen);
+            if(sched_gens(engine->sched, engine->cells, steps, engine->deltas, NULL, NULL, 0) != 0) {
+                engine->gen += gen;
+                return -1;
+            }
+
+            for(int step = 0; step < steps; step++) {
+                engine->hash ^= engine->deltas[step];
+            }
+            gen += steps;
+        }
+        else if(engine->frontier) {
+            engine->hash ^= frontier_step(engine->frontier, engine->cells, 1);
+            gen++;
+        }
+        else {
+            engine->hash ^= hnext_gen(engine->cells, engine->rows, engine->cols, engine->torus);
+            gen++;
+        }
+    }
+    engine->gen += gens;
+    return 0;
+}
+
+
+int engine_read(engine_t* engine, int x, int y, int width, int height, uint8_t* out) {
+    if(x < 0 || y < 0 || width < 0 || height < 0 || x + width > engine->cols - 2 || y + height > engine->rows - 2) {
+        return -1;
+    }
+
+    for(int i = 0; i < height; i++) {
+        uint8_t* row = engine->cells + (size_t) (y + i + 1) * engine->cols + x + 1;
+        for(int j = 0; j < width; j++) {
+            out[(size_t) i * width + j] = IS_ALIVE(row[j]);
+        }
+    }
+    return 0;
+}
+
+
+long long engine_population(engine_t* engine) {
+    return population(engine->cells, engine->rows, engine->cols);
+}
+
+
+uint64_t engine_hash(engine_t* engine) {
+    return engine->hash;
+}
+
+
+long long engine_generation(engine_t* engine) {
+    return engine->gen;
+}
+
+
+void engine_size(engine_t* engine, int* rows, int* columns) {
+    *rows = engine->rows - 2;
+    *columns = engine->cols - 2;
+}
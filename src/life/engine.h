@@ -0,0 +1,54 @@
+#ifndef _ENGINE
+#define _ENGINE
+
+#include <stdint.h>
+
+/*
+    Embeddable simulation, without MPI. Build the core library with `make liblife` and link against it:
+    gcc -Wall my_service.c -L build -llife -lpthread -lm -o my_service
+*/
+
+/* Types */
+// How an engine advances its universe. A zeroed struct (or NULL) is the default: the original rule, dead edges, untiled dense sweeps
+typedef struct _engine_config_t {
+    const char* rule; // B/S rule or rule name (see `rule_set(...)`), NULL for `RULE_DEFAULT`
+    int torus;
+    int tile; // side of the cache tiles (see tile.h), 0 untiled. Ignored on a torus
+    int time_block; // generations a tile is advanced in cache (or the pool runs between two stops), 0 for `TILE_DEFAULT_DEPTH`
+    double frontier; // density up to which only the cells next to the last flips are solved (see frontier.h), 0 for dense sweeps. Wins over `tile` and `threads`
+    int threads; // threads of a pool advancing `tile` sized tiles (see sched.h), 0 to step on the calling thread alone
+} engine_config_t;
+
+// Universe and everything needed to advance it, owned by the caller
+typedef struct _engine_t engine_t;
+
+/* Engine */
+// Engine over a `rows * columns` universe (no padding), cell (x, y) alive if `cells[y * columns + x]` is not 0. Returns NULL if the rule cannot be parsed, the sizes are not positive, or the universe (or the threads, tiles or lists of the configuration) cannot be allocated
+/*
+    **NOTE:**:
+        - Nothing in the engine exits the process: every failure comes back as NULL or -1
+*/
+// NOTE: Do NOT forget to free the returned pointer with `engine_free(...)`
+engine_t* engine_create(const uint8_t* cells, int rows, int columns, const engine_config_t* config);
+// Same, from a generation file (see `fload_gen(...)`). Also NULL if the file cannot be opened or is not a generation
+// NOTE: Do NOT forget to free the returned pointer with `engine_free(...)`
+engine_t* engine_load(char* path, const engine_config_t* config);
+void engine_free(engine_t* engine);
+
+// Advances the universe `gens` generations. Returns 0, or -1 if the thread pool has no memory for them, after the generations it could advance
+/*
+    **NOTE:**:
+        - The rule is a setting of the process (see rule.h): an engine switches to its own at every step, so engines with different rules can share a thread, but not run on two threads at once
+*/
+int engine_step(engine_t* engine, int gens);
+
+// Copies the alive bits (0 or 1) of the `width * height` cells from (x, y) to `out`, row by row. Returns 0 on success, -1 if the region leaves the universe
+int engine_read(engine_t* engine, int x, int y, int width, int height, uint8_t* out);
+long long engine_population(engine_t* engine);
+// Zobrist hash of the universe, the same as the golden hashes of the MPI driver
+uint64_t engine_hash(engine_t* engine);
+// Generations advanced since the engine was created
+long long engine_generation(engine_t* engine);
+void engine_size(engine_t* engine, int* rows, int* columns);
+
+#endif
@@ -0,0 +1,203 @@
+#include "frontier.h"
+#include "rule.h"
+#include "mem.h"
+
+#include <stdlib.h>
+
+
+// Index of the cell (i, j) of the padded universe, wrapped to the opposite edge on a torus. Returns 0 if it is in the dead ring
+static int frontier_at(frontier_t* frontier, int i, int j, size_t* idx) {
+    int last_row = frontier->rows - 2, last_col = frontier->cols - 2;
+    if(frontier->torus) {
+        if(i == 0) i = last_row;
+        else if(i == last_row + 1) i = 1;
+        if(j == 0) j = last_col;
+        else if(j == last_col + 1) j = 1;
+    }
+    else if(i == 0 || i == last_row + 1 || j == 0 || j == last_col + 1) {
+        return 0;
+    }
+
+    *idx = (size_t) i * frontier->cols + j;
+    return 1;
+}
+
+
+// Adds a cell to the candidates, unless it is there already. Going past the limit makes the next generation dense
+static void frontier_add(frontier_t* frontier, size_t idx) {
+    if(frontier->dense || frontier->marks[idx]) return;
+
+    if(frontier->cand_cnt == frontier->limit) {
+        frontier->dense = 1;
+        return;
+    }
+    frontier->marks[idx] = 1;
+    frontier->cands[frontier->cand_cnt++] = idx;
+}
+
+
+// Makes a flipped cell and its neighbours candidates, after updating their neighbour data if `update`
+static void frontier_spread(frontier_t* frontier, uint8_t* cells, size_t idx, int update) {
+    int moore = rule_get()->neighbourhood == RULE_MOORE;
+    int i = idx / frontier->cols, j = idx % frontier->cols;
+    size_t n;
+
+    frontier_add(frontier, idx);
+
+    for(int di = -1; di <= 1; di++) {
+        for(int dj = -1; dj <= 1; dj++) {
+            if((di == 0 && dj == 0) || (!moore && di != 0 && dj != 0)) continue;
+            if(!frontier_at(frontier, i + di, j + dj, &n)) continue;
+
+            if(update && moore) {
+                cells[n] += IS_ALIVE(cells[idx]) ? 2 : -2;
+            }
+            else if(update) {
+                // The flipped cell is west of the cell to its east, and so on
+                cells[n] ^= dj == 1 ? CELL_WEST : dj == -1 ? CELL_EAST : di == 1 ? CELL_NORTH : CELL_SOUTH;
+            }
+            frontier_add(frontier, n);
+        }
+    }
+}
+
+
+// Empties `marks` for the next list of candidates
+static void frontier_unmark(frontier_t* frontier) {
+    for(size_t k = 0; k < frontier->cand_cnt; k++) {
+        frontier->marks[frontier->cands[k]] = 0;
+    }
+}
+
+
+// Every cell, as `next_gen(...)` does, keeping the flips as long as they fit
+static uint64_t frontier_dense(frontier_t* frontier, uint8_t* cells, int hash) {
+    if(frontier->wait > 0) {
+        frontier->wait--;
+        if(hash) {
+            return hnext_gen(cells, frontier->rows, frontier->cols, frontier->torus);
+        }
+        next_gen(cells, frontier->rows, frontier->cols, frontier->torus);
+        return 0;
+    }
+
+    const uint8_t* lut = rule_get()->lut;
+    uint64_t delta = 0;
+    int overflow = 0;
+
+    frontier->flip_cnt = 0;
+    for(int i = 1; i < frontier->rows - 1; i++) {
+        for(int j = 1; j < frontier->cols - 1; j++) {
+            size_t idx = (size_t) i * frontier->cols + j;
+            uint8_t next = lut[cells[idx]];
+
+            if(IS_ALIVE(next ^ cells[idx])) {
+                if(hash) delta ^= zobrist(j, i);
+                if(frontier->flip_cnt < frontier->limit) {
+                    frontier->flips[frontier->flip_cnt++] = idx;
+                }
+                else {
+                    overflow = 1;
+                }
+            }
+            cells[idx] = next;
+        }
+    }
+
+    if(frontier->torus) {
+        wrap_ring(cells, frontier->rows, frontier->cols);
+    }
+    updater(cells, frontier->rows, frontier->cols);
+    if(frontier->torus) {
+        clear_ring(cells, frontier->rows, frontier->cols);
+    }
+
+    // The updater already rebuilt the neighbour data, only the candidates are left
+    frontier->cand_cnt = 0;
+    frontier->dense = overflow;
+    frontier->wait = overflow ? FRONTIER_RETRY : 0;
+    for(size_t k = 0; k < frontier->flip_cnt && !frontier->dense; k++) {
+        frontier_spread(frontier, cells, frontier->flips[k], 0);
+    }
+    frontier_unmark(frontier);
+
+    return delta;
+}
+
+
+// Only the candidates
+static uint64_t frontier_sparse(frontier_t* frontier, uint8_t* cells, int hash) {
+    const uint8_t* lut = rule_get()->lut;
+    uint64_t delta = 0;
+
+    // Every candidate is solved on the current generation before any flip is applied
+    frontier->flip_cnt = 0;
+    for(size_t k = 0; k < frontier->cand_cnt; k++) {
+        size_t idx = frontier->cands[k];
+        if(IS_ALIVE(lut[cells[idx]] ^ cells[idx])) {
+            frontier->flips[frontier->flip_cnt++] = idx;
+        }
+    }
+
+    frontier->cand_cnt = 0;
+    for(size_t k = 0; k < frontier->flip_cnt; k++) {
+        size_t idx = frontier->flips[k];
+        cells[idx] ^= CELL_ALIVE;
+        if(hash) delta ^= zobrist(idx % frontier->cols, idx / frontier->cols);
+
+        frontier_spread(frontier, cells, idx, 1);
+    }
+    frontier_unmark(frontier);
+
+    return delta;
+}
+
+
+frontier_t* frontier_create(int rows, int cols, int torus, double density) {
+    frontier_t* frontier = malloc(sizeof(frontier_t));
+    if(!frontier) return NULL;
+
+    frontier->rows = rows;
+    frontier->cols = cols;
+    frontier->torus = torus;
+    frontier->limit = (size_t) (density * (rows - 2) * (cols - 2));
+
+    // Sparse generations have at most `limit` candidates, so at most `limit` flips
+    frontier->cands = malloc((frontier->limit + 1) * sizeof(size_t));
+    frontier->flips = malloc((frontier->limit + 1) * sizeof(size_t));
+    frontier->marks = mem_try_alloc((size_t) rows * cols * sizeof(uint8_t));
+    if(!frontier->cands || !frontier->flips || !frontier->marks) {
+        frontier_free(frontier);
+        return NULL;
+    }
+
+    frontier->cand_cnt = 0;
+    frontier->flip_cnt = 0;
+    frontier->dense = 1;
+    frontier->wait = 0;
+    frontier->sparse_gens = 0;
+    frontier->dense_gens = 0;
+
+    return frontier;
+}
+
+
+void frontier_free(frontier_t* frontier) {
+    if(!frontier) return;
+
+    free(frontier->cands);
+    free(frontier->flips);
+    mem_free(frontier->marks);
+    free(frontier);
+}
+
+
+uint64_t frontier_step(frontier_t* frontier, uint8_t* cells, int hash) {
+    if(frontier->dense) {
+        frontier->dense_gens++;
+        return frontier_dense(frontier, cells, hash);
+    }
+
+    frontier->sparse_gens++;
+    return frontier_sparse(frontier, cells, hash);
+}
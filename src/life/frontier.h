@@ -0,0 +1,46 @@
+#ifndef _FRONTIER
+#define _FRONTIER
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "life.h"
+
+/* Constants */
+// Fraction of the cells above which a generation sweeps the whole universe, when not given (`--frontier`)
+#define FRONTIER_DEFAULT_DENSITY 0.05
+// Dense generations run with the kernels of `next_gen(...)` after one whose flips went past the limit, before flips are recorded again
+#define FRONTIER_RETRY 8
+
+/* Types */
+// Change list engine: only the cells next to the last flips can change, so only those are solved
+typedef struct _frontier_t {
+    int rows, cols; // padded universe
+    int torus;
+    size_t limit; // candidates above which the next generation is dense
+
+    size_t* cands; // cells that may change in the next generation, each once
+    size_t cand_cnt;
+    size_t* flips; // cells that flipped in the last generation
+    size_t flip_cnt;
+    uint8_t* marks; // 1 for the cells in `cands`, `rows * cols` bytes
+    int dense; // the next generation sweeps every cell
+    int wait; // dense generations left before recording flips again
+
+    long long sparse_gens, dense_gens;
+} frontier_t;
+
+/* Frontier */
+// Engine over a padded universe of `rows * cols` cells, dense for its first generation. Returns NULL if its lists do not fit in memory
+// NOTE: Do NOT forget to free the returned pointer with `frontier_free(...)`
+frontier_t* frontier_create(int rows, int cols, int torus, double density);
+void frontier_free(frontier_t* frontier);
+// Advances `cells` one generation, to the same cells (neighbour data included) as `next_gen(...)`. Returns the hash delta of the generation if `hash`, 0 otherwise
+/*
+    **NOTE:**:
+        - Sparse generations solve the candidates, flip the alive bit of those that change, and then update the neighbour data around each flip only (a bit of 4 cells for von Neumann rules, the count of 8 cells for Moore rules). The next candidates are the flipped cells and their neighbours, deduplicated with `marks`
+        - Once the candidates go past `density` of the universe, the next generation is the dense sweep of `next_gen(...)`, which records its flips to go back to sparse generations when they drop. Recording is slower than the kernels of `next_gen(...)`, so once a dense generation has too many flips the next `FRONTIER_RETRY` ones just use those
+*/
+uint64_t frontier_step(frontier_t* frontier, uint8_t* cells, int hash);
+
+#endif
@@ -1,4 +1,5 @@
 #include "life.h"
+#include "mem.h"
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -6,8 +7,9 @@
 #include <errno.h>
 #include <stdint.h>
 #include <sys/stat.h>
+#include <dirent.h>
 #include <math.h>
-#include <mpi.h>
+#include <limits.h>
 
 
 int _ldebug = 0;
@@ -25,8 +27,8 @@ void swapp(void** a, void** b) {
 int mequal(uint8_t* m1, uint8_t* m2, int rows, int cols) {
     for(int i = 0; i < rows; i++) {
         for(int j = 0; j < cols; j++) {
-            int idx = i * rows + j;
-            
+            size_t idx = (size_t) i * cols + j;
+
             if(IS_ALIVE(m1[idx]) != IS_ALIVE(m2[idx])) return 0;
         }
     }
@@ -34,6 +36,17 @@ int mequal(uint8_t* m1, uint8_t* m2, int rows, int cols) {
 }
 
 
+// Alive cells of a buffer
+long long population(uint8_t* cells, int rows, int cols) {
+    long long alive = 0;
+    size_t len = (size_t) rows * cols;
+    for(size_t i = 0; i < len; i++) {
+        alive += IS_ALIVE(cells[i]);
+    }
+    return alive;
+}
+
+
 /* Prints the 2 points that define the area */
 void print_area(area_t area) {
     fprintf(stdout, "(%d, %d), (%d, %d)\n", area.from[0], area.from[1], area.to[0], area.to[1]);
@@ -47,6 +60,16 @@ void print_areas(area_t* areas, int len) {
 }
 
 
+int area_meet(const area_t* a, const area_t* b, area_t* out) {
+    for(int k = 0; k < 2; k++) {
+        out->from[k] = MAX(a->from[k], b->from[k]);
+        out->to[k] = MIN(a->to[k], b->to[k]);
+        if(out->from[k] > out->to[k]) return 0;
+    }
+    return 1;
+}
+
+
 void print_bin(uint8_t num) {
     for(int i = 7; i >= 0; i--) {
         printf("%d", num & (1 << i) ? 1 : 0);
@@ -73,7 +96,7 @@ void mprint_binc(
 ) {
     for(int i = 0; i < rows; i++) {
         for(int j = 0; j < cols; j++) {
-            print_binc(mat[i * cols + j], alive, n_alive);
+            print_binc(mat[(size_t) i * cols + j], alive, n_alive);
             printf(" ");
         }
         printf("\n");
@@ -81,7 +104,7 @@ void mprint_binc(
 }
 
 
-// NOTE: Do NOT forget to free the returned pointer
+// NOTE: Do NOT forget to free the returned pointer with `mem_free(...)`
 uint8_t* get_chunk(
     uint8_t* buffer, // full buffer of cells
     int rows, // buffer row count
@@ -92,24 +115,33 @@ uint8_t* get_chunk(
     int chunk_rows = end[1] - start[1] + 1;
     int chunk_cols = end[0] - start[0] + 1;
 
-    uint8_t* chunk = calloc(chunk_rows * chunk_cols, sizeof(uint8_t));
-    if(!chunk) {
-        perror("Error allocating chunk array");
-        exit(errno);
-    }
+    uint8_t* chunk = mem_alloc((size_t) chunk_rows * chunk_cols * sizeof(uint8_t));
 
-    for(int i = start[1]; i <= end[1]; i++) {
-        for(int j = start[0]; j <= end[0]; j++) {
-            int buff_idx = i * columns + j;
-            int chunk_idx = (i - start[1]) * chunk_cols + (j - start[0]);
-            chunk[chunk_idx] = buffer[buff_idx];
-        }
-    }
+    copy_chunk(chunk, buffer, rows, columns, start, end);
 
     return chunk;
 }
 
 
+// Same as `get_chunk(...)`, into an already allocated `chunk`
+void copy_chunk(
+    uint8_t* chunk,
+    uint8_t* buffer,
+    int rows,
+    int columns,
+    int* start,
+    int* end
+) {
+    // Rows only bound `start` and `end`, which the caller keeps inside the buffer
+    (void) rows;
+    int chunk_cols = end[0] - start[0] + 1;
+
+    for(int i = start[1]; i <= end[1]; i++) {
+        memcpy(chunk + (size_t) (i - start[1]) * chunk_cols, buffer + (size_t) i * columns + start[0], chunk_cols * sizeof(uint8_t));
+    }
+}
+
+
 void place_chunk(
     uint8_t* buffer,
     int rows,
@@ -118,15 +150,42 @@ void place_chunk(
     int* start,
     int* end
 ) {
+    (void) rows;
     // int chunk_rows = end[1] - start[1] + 1;
     int chunk_cols = end[0] - start[0] + 1;
 
     for(int i = start[1]; i <= end[1]; i++) {
-        for(int j = start[0]; j <= end[0]; j++) {
-            int buff_idx = i * columns + j;
-            int chunk_idx = (i - start[1]) * chunk_cols + (j - start[0]);
-            buffer[buff_idx] = chunk[chunk_idx];
-        }
+        memcpy(buffer + (size_t) i * columns + start[0], chunk + (size_t) (i - start[1]) * chunk_cols, chunk_cols * sizeof(uint8_t));
+    }
+}
+
+
+// Kills the outer ring of a buffer (first and last rows and columns)
+void clear_ring(uint8_t* buffer, int rows, int columns) {
+    memset(buffer, 0, columns * sizeof(uint8_t));
+    memset(buffer + (size_t) (rows - 1) * columns, 0, columns * sizeof(uint8_t));
+    for(int i = 1; i < rows - 1; i++) {
+        size_t row = (size_t) i * columns;
+        buffer[row] = 0;
+        buffer[row + columns - 1] = 0;
+    }
+}
+
+
+// Torus: copies the opposite edges of the universe into its padding ring. Rows go first, so the corners get the diagonally opposite cells
+void wrap_ring(uint8_t* buffer, int rows, int columns) {
+    memcpy(buffer, buffer + (size_t) (rows - 2) * columns, columns * sizeof(uint8_t));
+    memcpy(buffer + (size_t) (rows - 1) * columns, buffer + columns, columns * sizeof(uint8_t));
+    wrap_cols(buffer, rows, columns);
+}
+
+
+// Same as `wrap_ring(...)`, only for the side columns (all the rows)
+void wrap_cols(uint8_t* buffer, int rows, int columns) {
+    for(int i = 0; i < rows; i++) {
+        size_t row = (size_t) i * columns;
+        buffer[row] = buffer[row + columns - 2];
+        buffer[row + columns - 1] = buffer[row + 1];
     }
 }
 
@@ -144,12 +203,11 @@ void validate_path(char* path) {
     }
     rebuilt_path[0] = '\0';
 
-    while(token) {
+    // Every part but the last one (the file name) is a directory, dots or not
+    char* next = token ? strtok(NULL, delims) : NULL;
+    while(next) {
         // printf("%s -> %s\n", rebuilt_path, token);
         fflush(stdout);
-        if(strchr(token, '.') && strlen(token) > 1) {
-            break;
-        }
 
         path_len += strlen(token) + 1;
         rebuilt_path = realloc(rebuilt_path, path_len);
@@ -179,7 +237,8 @@ void validate_path(char* path) {
             }
         }
 
-        token = strtok(NULL, delims);
+        token = next;
+        next = strtok(NULL, delims);
     }
 
     free(rebuilt_path);
@@ -188,8 +247,11 @@ void validate_path(char* path) {
 
 // NOTE: Do NOT forget to free the returned pointer
 char* get_output_path(char* in_name, char* type) {
+    #ifdef _WIN32
     char* win_sep = "\\";
+    #else
     char* unix_sep = "/";
+    #endif
 
     // printf("start\n");
     // fflush(stdout);
@@ -202,8 +264,8 @@ char* get_output_path(char* in_name, char* type) {
     // printf("%s\n", where);
     // fflush(stdout);
 
-    char in_name_no_prefix[strlen(in_name)];
-    strcpy(in_name_no_prefix, where + 1);
+    char in_name_no_prefix[strlen(in_name) + 1];
+    strcpy(in_name_no_prefix, where ? where + 1 : in_name);
 
     // printf("%s\n", in_name_no_prefix);
     // fflush(stdout);
@@ -211,8 +273,9 @@ char* get_output_path(char* in_name, char* type) {
     where = strrchr(in_name_no_prefix, '.');
     int how_much = where - in_name_no_prefix;
 
-    char name_no_suffix[strlen(in_name)];
+    char name_no_suffix[strlen(in_name) + 1];
     strncpy(name_no_suffix, in_name_no_prefix, how_much);
+    name_no_suffix[how_much] = '\0';
 
     // printf("%s\n", name_no_suffix);
     // fflush(stdout);
@@ -263,79 +326,126 @@ char* get_output_path(char* in_name, char* type) {
 }
 
 
-// Loads a generation into an array (interpreted as a matrix, with a buffer of 0's of size 1), and passes the number of rows and columns as parameters (this does not take into account the 0 buffer)
-uint8_t* fload_gen(
-    char* in_file_name, // Input file's name
-    int* rows, // Variable that will hold the amount of rows the matrix has
-    int* columns // Variable that will hold the amount of collums the matrix has
-) {
-    // Open input file and read dimentions
+// Opens a generation file and reads its dimensions. The rows follow, see `fread_rows(...)`
+// NOTE: Do NOT forget to close the returned file with `fclose(...)`
+FILE* fopen_gen(char* in_file_name, int* rows, int* columns) {
     FILE* in_file = fopen(in_file_name, "r");
     if(!in_file) {
         perror("Error while opening input file");
         exit(errno);
     }
 
-    fscanf(in_file, "%d%d", rows, columns);
+    if(fscanf(in_file, "%d%d", rows, columns) != 2 || *rows < 1 || *columns < 1) {
+        printf("Invalid dimensions at the start of `%s`\n", in_file_name);
+        fflush(stdout);
+        exit(-1);
+    }
 
-    // Declare generation buffer
-    int rows_real = *rows + 2;
-    int cols_real = *columns + 2;
-    uint8_t* buffer = calloc(rows_real * cols_real, sizeof(uint8_t));
-    if(!buffer) {
-        perror("Error while allocating initial buffer");
+    return in_file;
+}
+
+
+// Reads the next `rows` rows of a generation file into `cells`, whose rows are `row_len` cells long. Only the alive bits are set
+void fread_rows(FILE* in_file, uint8_t* cells, int rows, int columns, int row_len) {
+    int err = fparse_rows(in_file, cells, rows, columns, row_len);
+    if(err < 0) {
+        perror("Error at reading input line");
         exit(errno);
     }
+    if(err > 0) {
+        printf("Invalid character at input `%c`", err);
+        fflush(stdout);
+        exit(-1);
+    }
+}
 
-    // Read rest of input file
-    int rw = 1, cl = 1;
-    while(rw <= *rows) {
-        char line[IN_CHUNK];
-        if(!fgets(line, IN_CHUNK, in_file)) {
-            perror("Error at reading input line");
-            exit(errno);
-        }
 
-        int line_len = strlen(line);
-        if(line[line_len - 1] == '\n') {
-            line[line_len - 1] = '\0';
-        }
+int fparse_rows(FILE* in_file, uint8_t* cells, int rows, int columns, int row_len) {
+    // Characters past the last column wrap around to the first one, as they always did
+    int rw = 0, cl = 0, seen = 0, c = 0;
+    while(rw < rows) {
+        if((c = getc(in_file)) == EOF) {
+            // The last row may end the file without a newline
+            if(seen && rw == rows - 1) break;
 
-        line_len = strlen(line);
-        // printf("line: %s\nlen:%d\n\n", line, line_len);
-        for(int i = 0; i < line_len; i++) {
-            int idx = rw * cols_real + cl;
-            int idx_w = rw * cols_real + (cl - 1);
-            int idx_n = (rw - 1) * cols_real + cl;
-
-            switch(line[i]) {
-                case 'X': 
-                    buffer[idx] |= CELL_ALIVE | (IS_ALIVE(buffer[idx_w]) * CELL_WEST) | (IS_ALIVE(buffer[idx_n]) * CELL_NORTH);
-                    buffer[idx_w] |= CELL_EAST;
-                    buffer[idx_n] |= CELL_SOUTH; 
-                    break;
-                case '.':
-                    buffer[idx] |= (IS_ALIVE(buffer[idx_w]) * CELL_WEST) | (IS_ALIVE(buffer[idx_n]) * CELL_NORTH);
-                    break;
-                default:
-                    printf("Invalid character at input `%c`", line[i]);
-                    fflush(stdout);
-                    exit(-1);
-            }
+            return -1;
+        }
 
-            cl++;
-            if(cl > *columns) {
-                cl = 1;
-            }
+        switch(c) {
+            case 'X':
+                cells[(size_t) rw * row_len + cl] = CELL_ALIVE;
+                break;
+            case '.':
+                cells[(size_t) rw * row_len + cl] = 0;
+                break;
+            case '\n':
+                // Empty lines do not count as rows
+                if(seen) {
+                    rw++;
+                    cl = seen = 0;
+                }
+                continue;
+            case '\r':
+                continue;
+            default:
+                return c;
         }
 
-        if(line_len > 0) {
-            rw++;
+        seen = 1;
+        if(++cl >= columns) {
+            cl = 0;
         }
     }
 
+    return 0;
+}
+
+
+// Loads a generation into an array (interpreted as a matrix, with a buffer of 0's of size 1), and passes the number of rows and columns as parameters (this does not take into account the 0 buffer)
+// NOTE: Do NOT forget to free the returned pointer with `mem_free(...)`
+uint8_t* fload_gen(
+    char* in_file_name, // Input file's name
+    int* rows, // Variable that will hold the amount of rows the matrix has
+    int* columns // Variable that will hold the amount of collums the matrix has
+) {
+    FILE* in_file = fopen_gen(in_file_name, rows, columns);
+
+    // Declare generation buffer
+    int rows_real = *rows + 2;
+    int cols_real = *columns + 2;
+    uint8_t* buffer = mem_alloc((size_t) rows_real * cols_real * sizeof(uint8_t));
+
+    fread_rows(in_file, buffer + cols_real + 1, *rows, *columns, cols_real);
+
     fclose(in_file);
 
+    // Neighbour data for the rule in use
+    updater(buffer, rows_real, cols_real);
+
+    return buffer;
+}
+
+
+uint8_t* fparse_gen(char* in_file_name, int* rows, int* columns) {
+    FILE* in_file = fopen(in_file_name, "r");
+    if(!in_file) return NULL;
+
+    uint8_t* buffer = NULL;
+    if(fscanf(in_file, "%d%d", rows, columns) == 2 && *rows > 0 && *columns > 0) {
+        int rows_real = *rows + 2;
+        int cols_real = *columns + 2;
+        buffer = mem_try_alloc((size_t) rows_real * cols_real * sizeof(uint8_t));
+
+        if(buffer && fparse_rows(in_file, buffer + cols_real + 1, *rows, *columns, cols_real) != 0) {
+            mem_free(buffer);
+            buffer = NULL;
+        }
+        if(buffer) {
+            updater(buffer, rows_real, cols_real);
+        }
+    }
+
+    fclose(in_file);
     return buffer;
 }
 
@@ -348,6 +458,17 @@ void fwrite_gen(
     int cols,
     float t_elapsed // Optional parameter. If <0, will be ignored
 ) {
+    FILE* out_file = fopen_result(out_file_name, t_elapsed);
+
+    fwrite_rows(out_file, cells, rows, cols, cols);
+
+    fclose(out_file);
+}
+
+
+// Creates an output file (and its directories) and writes the time if given (>= 0). The rows follow, see `fwrite_rows(...)`
+// NOTE: Do NOT forget to close the returned file with `fclose(...)`
+FILE* fopen_result(char* out_file_name, float t_elapsed) {
     char file_path[strlen(out_file_name) + 1];
     strcpy(file_path, out_file_name);
     validate_path(file_path);
@@ -363,27 +484,224 @@ void fwrite_gen(
         fprintf(out_file, "%f\n", t_elapsed);
     }
 
+    return out_file;
+}
+
+
+// Writes `rows` rows of `cols` cells the way `fwrite_gen(...)` does, from a buffer whose rows are `row_len` cells long
+void fwrite_rows(FILE* out_file, uint8_t* cells, int rows, int cols, int row_len) {
+    char line[cols + 1];
+    line[cols] = '\n';
+
     for(int i = 0; i < rows; i++) {
+        const uint8_t* row = cells + (size_t) i * row_len;
         for(int j = 0; j < cols; j++) {
-            int idx = i * cols + j;
+            line[j] = IS_ALIVE(row[j]) ? 'X' : '.';
+        }
+        fwrite(line, sizeof(char), cols + 1, out_file);
+    }
+}
+
+
+// Loads a generation written by `fwrite_gen(...)` (with its time). Only the alive bits are restored, which is enough to compare results
+// NOTE: Do NOT forget to free the returned pointer with `mem_free(...)`
+uint8_t* fload_result(
+    char* in_file_name,
+    int rows, // Expected rows of the written buffer
+    int cols, // Expected columns of the written buffer
+    float* t_elapsed // Time stored in the file
+) {
+    FILE* in_file = fopen(in_file_name, "r");
+    if(!in_file) {
+        perror("Error while opening result file");
+        exit(errno);
+    }
+
+    if(fscanf(in_file, "%f", t_elapsed) != 1) {
+        printf("Missing time at the start of `%s`\n", in_file_name);
+        fflush(stdout);
+        exit(-1);
+    }
+
+    size_t len = (size_t) rows * cols;
+    uint8_t* buffer = mem_alloc(len * sizeof(uint8_t));
+
+    size_t idx = 0;
+    int c = 0;
+    while(idx < len && (c = fgetc(in_file)) != EOF) {
+        switch(c) {
+            case 'X':
+                buffer[idx++] = CELL_ALIVE;
+                break;
+            case '.':
+                buffer[idx++] = 0;
+                break;
+            case '\n':
+            case '\r':
+                break;
+            default:
+                printf("Invalid character at result `%c`", c);
+                fflush(stdout);
+                exit(-1);
+        }
+    }
 
-            fprintf(out_file, "%c", IS_ALIVE(cells[idx]) ? 'X' : '.');
+    fclose(in_file);
+
+    if(idx != len) {
+        printf("Result `%s` has %zu cells, expected %zu\n", in_file_name, idx, len);
+        fflush(stdout);
+        exit(-1);
+    }
+
+    return buffer;
+}
+
+
+// Looks up the golden hash of `key` after `gens` generations. Returns 1 if found, 0 otherwise (also if the file does not exist yet)
+int fload_golden(char* golden_file_name, char* key, int gens, uint64_t* hash) {
+    FILE* golden_file = fopen(golden_file_name, "r");
+    if(!golden_file) {
+        return 0;
+    }
+
+    char line_key[IN_CHUNK];
+    int line_gens = -1;
+    unsigned long long line_hash = 0;
+    int found = 0;
+
+    // Later entries override older ones
+    while(fscanf(golden_file, "%1023s %d %llx", line_key, &line_gens, &line_hash) == 3) {
+        if(strcmp(line_key, key) == 0 && line_gens == gens) {
+            *hash = line_hash;
+            found = 1;
         }
-        fprintf(out_file, "\n");
     }
 
+    fclose(golden_file);
+
+    return found;
+}
+
+
+// Appends a golden hash entry: `<key> <gens> <hash>`
+void fwrite_golden(char* golden_file_name, char* key, int gens, uint64_t hash) {
+    FILE* golden_file = fopen(golden_file_name, "a");
+    if(!golden_file) {
+        perror("Error opening golden hash file");
+        exit(errno);
+    }
+
+    fprintf(golden_file, "%s %d %016llx\n", key, gens, (unsigned long long) hash);
+
+    fclose(golden_file);
+}
+
+
+void fwrite_region(char* out_file_name, uint8_t* cells, int rows, int cols, int row_len) {
+    FILE* out_file = fopen_result(out_file_name, -1);
+
+    fprintf(out_file, "%d %d\n", rows, cols);
+    fwrite_rows(out_file, cells, rows, cols, row_len);
+
     fclose(out_file);
 }
 
 
-// Solver for the next generation. In place modifications
-void solver(uint8_t* cells, int rows, int cols) {
-    for(int i = 0; i < rows; i++) {
-        for(int j = 0; j < cols; j++) {
-            int idx = i * cols + j;
-            cells[idx] = (cells[idx] & 0xfe) | MAKE_ALIVE(cells[idx]);
+void fwrite_stats(char* stats_file_name, gen_stats_t* stats, int gens) {
+    FILE* stats_file = fopen_result(stats_file_name, -1);
+
+    fprintf(stats_file, "generation,population,births,deaths,min_x,min_y,max_x,max_y\n");
+    for(int gen = 0; gen < gens; gen++) {
+        gen_stats_t* g = &stats[gen];
+        int empty = g->min_x > g->max_x;
+        fprintf(stats_file, "%d,%lld,%lld,%lld,%d,%d,%d,%d\n", gen + 1, g->population, g->births, g->deaths,
+            empty ? -1 : g->min_x - 1, empty ? -1 : g->min_y - 1, empty ? -1 : g->max_x - 1, empty ? -1 : g->max_y - 1);
+    }
+
+    fclose(stats_file);
+}
+
+
+static int cmp_paths(const void* a, const void* b) {
+    return strcmp(*(char* const*) a, *(char* const*) b);
+}
+
+
+// Inputs of a batch: every `.txt` file of a directory (sorted by name), or the paths listed in a manifest file, one per line (`#` starts a comment)
+// NOTE: Do NOT forget to free every path and the returned pointer
+char** fload_manifest(char* manifest_name, int* count) {
+    char** paths = NULL;
+    int cnt = 0, cap = 0;
+    char line[IN_CHUNK];
+
+    struct stat st;
+    if(stat(manifest_name, &st) != 0) {
+        perror("Error while opening batch manifest");
+        exit(errno);
+    }
+
+    DIR* dir = S_ISDIR(st.st_mode) ? opendir(manifest_name) : NULL;
+    FILE* manifest = dir ? NULL : fopen(manifest_name, "r");
+    if(!dir && !manifest) {
+        perror("Error while opening batch manifest");
+        exit(errno);
+    }
+
+    while(1) {
+        if(dir) {
+            struct dirent* entry = readdir(dir);
+            if(!entry) break;
+
+            char* ext = strrchr(entry->d_name, '.');
+            if(entry->d_name[0] == '.' || !ext || strcmp(ext, ".txt") != 0) continue;
+
+            snprintf(line, IN_CHUNK, "%s/%s", manifest_name, entry->d_name);
+        }
+        else {
+            if(!fgets(line, IN_CHUNK, manifest)) break;
+
+            line[strcspn(line, "#\r\n")] = '\0';
+            // Blanks around the path
+            int start = strspn(line, " \t");
+            int len = strlen(line);
+            while(len > start && (line[len - 1] == ' ' || line[len - 1] == '\t')) line[--len] = '\0';
+            if(len == start) continue;
+            memmove(line, line + start, len - start + 1);
+        }
+
+        if(cnt == cap) {
+            cap = cap ? 2 * cap : 64;
+            paths = realloc(paths, cap * sizeof(char*));
+            if(!paths) {
+                perror("Error allocating batch list");
+                exit(errno);
+            }
+        }
+        paths[cnt] = strdup(line);
+        if(!paths[cnt]) {
+            perror("Error allocating batch list");
+            exit(errno);
         }
+        cnt++;
     }
+
+    if(dir) {
+        closedir(dir);
+        qsort(paths, cnt, sizeof(char*), cmp_paths);
+    }
+    else {
+        fclose(manifest);
+    }
+
+    *count = cnt;
+    return paths;
+}
+
+
+// Solver for the next generation. In place modifications
+void solver(uint8_t* cells, int rows, int cols) {
+    rule_solver(cells, rows, cols);
 }
 
 
@@ -395,47 +713,210 @@ void usolver(uint8_t* cells, int rows, int cols) {
 
 
 void updater(uint8_t* cells, int rows, int cols) {
-    // row = 0 and col = 0 is the "bandaid" from the other operation, so we start from row = 1, col = 1
-    for(int i = 1; i < rows; i++) {
-        for(int j = 1; j < cols; j++) {
-            int idx = i * cols + j;
-            int idx_n = (i - 1) * cols + j;
-            int idx_w = i * cols + (j - 1);
-
-            cells[idx] = IS_ALIVE(cells[idx]) | (CELL_NORTH * IS_ALIVE(cells[idx_n])) | (CELL_WEST * IS_ALIVE(cells[idx_w]));
-            cells[idx_n] = (cells[idx_n] & ~CELL_SOUTH) |  (CELL_SOUTH * IS_ALIVE(cells[idx]));
-            cells[idx_w] = (cells[idx_w] & ~CELL_EAST) | (CELL_EAST * IS_ALIVE(cells[idx]));
+    rule_updater(cells, rows, cols);
+}
+
+
+// Senquential solver for a next generation. Needs the whole buffer. In-place operation
+/*
+    **NOTE:**:
+        - The padding ring is solved together with the cells, but the updater never gives it neighbour data, so it stays dead (rules cannot have B0)
+        - On a `torus`, the ring holds the opposite edges while the updater runs, and is cleared again afterwards
+*/
+void next_gen(uint8_t* buffer, int buff_rows, int buff_cols, int torus) {
+    solver(buffer, buff_rows, buff_cols);
+
+    if(torus) {
+        wrap_ring(buffer, buff_rows, buff_cols);
+    }
+    updater(buffer, buff_rows, buff_cols);
+    if(torus) {
+        clear_ring(buffer, buff_rows, buff_cols);
+    }
+}
+
+
+// splitmix64 finalizer over the packed position
+uint64_t zobrist(int x, int y) {
+    uint64_t z = (((uint64_t) (uint32_t) y) << 32 | (uint32_t) x) + 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+
+uint64_t ghash(uint8_t* cells, int rows, int cols, int* start) {
+    uint64_t hash = 0;
+    for(int i = 0; i < rows; i++) {
+        for(int j = 0; j < cols; j++) {
+            if(IS_ALIVE(cells[(size_t) i * cols + j])) {
+                hash ^= zobrist(start[0] + j, start[1] + i);
+            }
         }
     }
+    return hash;
 }
 
 
-// Senquential solver for a next generation. Needs the whole buffer. In-place operation
-void next_gen(uint8_t* buffer, int buff_rows, int buff_cols) {
-    // solver(buffer, buff_rows, buff_cols);
-    // updater(buffer, buff_rows, buff_cols);
+// Solver that keeps track of the flipped cells. In place modifications
+uint64_t hsolver(uint8_t* cells, int rows, int cols, int* start) {
+    const uint8_t* lut = rule_get()->lut;
+    uint64_t delta = 0;
+    for(int i = 0; i < rows; i++) {
+        for(int j = 0; j < cols; j++) {
+            size_t idx = (size_t) i * cols + j;
+            uint8_t next = lut[cells[idx]];
+
+            if(IS_ALIVE(next ^ cells[idx])) {
+                delta ^= zobrist(start[0] + j, start[1] + i);
+            }
+            cells[idx] = next;
+        }
+    }
+    return delta;
+}
+
+
+uint64_t hnext_gen(uint8_t* buffer, int buff_rows, int buff_cols, int torus) {
+    int from[] = {0, 0};
+
+    uint64_t delta = hsolver(buffer, buff_rows, buff_cols, from);
+
+    if(torus) {
+        wrap_ring(buffer, buff_rows, buff_cols);
+    }
+    updater(buffer, buff_rows, buff_cols);
+    if(torus) {
+        clear_ring(buffer, buff_rows, buff_cols);
+    }
+
+    return delta;
+}
+
 
+void stats_clear(gen_stats_t* stats) {
+    *stats = (gen_stats_t) {
+        population: 0,
+        births: 0,
+        deaths: 0,
+        min_x: INT_MAX,
+        min_y: INT_MAX,
+        max_x: -1,
+        max_y: -1
+    };
+}
+
+
+void stats_merge(gen_stats_t* stats, const gen_stats_t* other) {
+    stats->population += other->population;
+    stats->births += other->births;
+    stats->deaths += other->deaths;
+    stats->min_x = MIN(stats->min_x, other->min_x);
+    stats->min_y = MIN(stats->min_y, other->min_y);
+    stats->max_x = MAX(stats->max_x, other->max_x);
+    stats->max_y = MAX(stats->max_y, other->max_y);
+}
+
+
+uint64_t ssolver(uint8_t* cells, int rows, int cols, int* start, gen_stats_t* stats, dmap_t* map) {
+    const uint8_t* lut = rule_get()->lut;
+    gen_stats_t unused;
+    if(!stats) {
+        stats_clear(&unused);
+        stats = &unused;
+    }
+    uint64_t delta = 0;
+    long long births = 0, flips = 0;
+
+    for(int i = 0; i < rows; i++) {
+        // Only the flips (rare) branch. The ends of a row with alive cells are looked for afterwards, while it is still in cache
+        int row_alive = 0, first = -1, last = -1;
+        for(int j = 0; j < cols; j++) {
+            size_t idx = (size_t) i * cols + j;
+            uint8_t next = lut[cells[idx]];
+            int alive = IS_ALIVE(next);
+
+            if(IS_ALIVE(next ^ cells[idx])) {
+                delta ^= zobrist(start[0] + j, start[1] + i);
+                births += alive;
+                flips++;
+            }
+            row_alive += alive;
+            cells[idx] = next;
+        }
+
+        if(row_alive > 0) {
+            for(first = 0; !IS_ALIVE(cells[(size_t) i * cols + first]); first++);
+            for(last = cols - 1; !IS_ALIVE(cells[(size_t) i * cols + last]); last--);
+
+            stats->population += row_alive;
+            stats->min_x = MIN(stats->min_x, start[0] + first);
+            stats->max_x = MAX(stats->max_x, start[0] + last);
+            stats->min_y = MIN(stats->min_y, start[1] + i);
+            stats->max_y = MAX(stats->max_y, start[1] + i);
+        }
+        if(map) {
+            dmap_row(map, cells + (size_t) i * cols, start[1] + i, start[0], cols);
+        }
+    }
+
+    stats->births += births;
+    stats->deaths += flips - births;
+    return delta;
+}
+
+
+uint64_t snext_gen(uint8_t* buffer, int buff_rows, int buff_cols, int torus, gen_stats_t* stats, dmap_t* map) {
     int from[] = {0, 0};
-    int to[] = {buff_cols - 1, buff_rows - 1};
-    // Gets work area = cells + padding
-    uint8_t* work_area = get_chunk(buffer, buff_rows, buff_cols, from, to);
 
-    // Solver works on the whole buffer
-    solver(work_area, buff_rows, buff_cols);
-    // Updates just the cells, since padding doesn't matter
-    updater(work_area, buff_rows, buff_cols);
+    uint64_t delta = ssolver(buffer, buff_rows, buff_cols, from, stats, map);
+
+    if(torus) {
+        wrap_ring(buffer, buff_rows, buff_cols);
+    }
+    updater(buffer, buff_rows, buff_cols);
+    if(torus) {
+        clear_ring(buffer, buff_rows, buff_cols);
+    }
+
+    return delta;
+}
+
 
-    from[0] = 1; from[1] = 1;
-    to[0] = buff_cols - 2; to[1] = buff_rows - 2;
-    // Gets updated cells
-    uint8_t* truth = get_chunk(work_area, buff_rows, buff_cols, from, to);
+uint64_t msolver(uint8_t* cells, int rows, int cols, int* start, int hash, dmap_t* map) {
+    uint64_t delta = 0;
+
+    for(int i = 0; i < rows; i++) {
+        uint8_t* row = cells + (size_t) i * cols;
+        int row_start[] = {start[0], start[1] + i};
 
-    // Replaces the cells in the buffer
-    place_chunk(buffer, buff_rows, buff_cols, truth, from, to);
+        if(hash) {
+            delta ^= hsolver(row, 1, cols, row_start);
+        }
+        else {
+            solver(row, 1, cols);
+        }
+        dmap_row(map, row, row_start[1], row_start[0], cols);
+    }
 
-    // Clean-up
-    free(work_area);
-    free(truth);
+    return delta;
+}
+
+
+uint64_t mnext_gen(uint8_t* buffer, int buff_rows, int buff_cols, int torus, int hash, dmap_t* map) {
+    int from[] = {0, 0};
+
+    uint64_t delta = msolver(buffer, buff_rows, buff_cols, from, hash, map);
+
+    if(torus) {
+        wrap_ring(buffer, buff_rows, buff_cols);
+    }
+    updater(buffer, buff_rows, buff_cols);
+    if(torus) {
+        clear_ring(buffer, buff_rows, buff_cols);
+    }
+
+    return delta;
 }
 
 
@@ -479,16 +960,31 @@ area_t* create_jobs_2d(int rows, int columns, int workers, int* job_cnt, int* wo
         }
     }
     
-    int nblocks = blocksx * blocksy;
-    int block_height = rows / blocksy;
-    int block_width = columns / blocksx;
+    *workers_x = blocksx;
+    return create_jobs_grid(rows, columns, blocksx, blocksy, job_cnt);
+}
 
-    area_t* blocks = calloc(nblocks, sizeof(area_t));
+
+// `blocksx` x `blocksy` blocks, the last ones of each row and column taking what is left
+// NOTE: Do NOT forget to free the returned pointer with `free(...)`
+area_t* create_jobs_grid(int rows, int columns, int blocksx, int blocksy, int* job_cnt) {
+    area_t* blocks = calloc(blocksx * blocksy, sizeof(area_t));
     if(!blocks) {
-        perror("Error allocating memory for jobs list (2D)");
+        perror("Error allocating memory for jobs list (grid)");
         exit(errno);
     }
 
+    fill_jobs_grid(blocks, rows, columns, blocksx, blocksy);
+
+    *job_cnt = blocksx * blocksy;
+    return blocks;
+}
+
+
+void fill_jobs_grid(area_t* blocks, int rows, int columns, int blocksx, int blocksy) {
+    int block_height = rows / blocksy;
+    int block_width = columns / blocksx;
+
     int i, j;
     for(i = 0; i < blocksy - 1; i++) {
         for(j = 0; j < blocksx - 1; j++) {
@@ -536,301 +1032,4 @@ area_t* create_jobs_2d(int rows, int columns, int workers, int* job_cnt, int* wo
                 rows
             }
         };
-
-    *job_cnt = nblocks;
-    *workers_x = blocksx;
-    return blocks;
 }
-
-
-void worker_parallel_1d(int rank, int nworkers) {
-    int rows = -1, cols = -1;
-    
-    MPI_Recv(&rows, 1, MPI_INT, 0, HEADER_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-    
-    if(_ldebug) {
-        printf("[%d]: Received rows from master: %d\n", rank, rows);
-        fflush(stdout);
-    }
-    
-    MPI_Recv(&cols, 1, MPI_INT, 0, HEADER_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-    
-    if(_ldebug) {
-        printf("[%d]: Received cols from master: %d\n", rank, cols);
-        fflush(stdout);
-    }
-    
-    uint8_t* data = calloc(rows * cols, sizeof(uint8_t));
-    if(!data) {
-        perror("Failed to allocate space for data in worker (1D)");
-        exit(errno);
-    }
-    MPI_Recv(data, rows * cols, MPI_UINT8_T, 0, HEADER_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-    
-    if(_ldebug) {
-        printf("[%d]: Received data from master: %d (len)\n", rank, rows * cols);
-        fflush(stdout);
-    }
-
-
-    solver(data, rows, cols);
-
-
-    MPI_Barrier(MPI_COMM_WORLD); // Wait for solver
-
-
-    uint8_t* data_with_halos = calloc((rows + 2) * (cols + 2), sizeof(uint8_t));
-    if(!data_with_halos) {
-        perror("Error allocating space for halos");
-        exit(errno);
-    }
-    int from[] = {1, 1};
-    int to[] = {cols, rows};
-
-    place_chunk(data_with_halos, rows + 2, cols + 2, data, from, to);
-
-    // Halos
-    uint8_t* recv_halo = calloc(cols, sizeof(uint8_t));
-    if(!recv_halo) {
-        perror("Error allocating memory for halo line");
-        exit(errno);
-    }
-
-    // Halo up - Send up, receive down
-    int from_hup[] = {0, 0};
-    int to_hup[] = {cols - 1, 0};
-    uint8_t* halo_up = get_chunk(data, rows, cols, from_hup, to_hup);
-    if(rank == 1) {
-        MPI_Recv(recv_halo, cols, MPI_UINT8_T, rank + 1, DATA_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-    }
-    else if(rank == nworkers) {
-        MPI_Send(halo_up, cols, MPI_UINT8_T, rank - 1, DATA_TAG, MPI_COMM_WORLD);
-        memset(recv_halo, 0, sizeof(uint8_t) * cols);
-    }
-    else {
-        MPI_Sendrecv(halo_up, cols, MPI_UINT8_T, rank - 1, DATA_TAG, 
-                    recv_halo, cols, MPI_UINT8_T, rank + 1, DATA_TAG,
-                    MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-    }
-    free(halo_up);
-
-    from[0] = 1; from[1] = rows + 1;
-    to[0] = cols; to[1] = rows + 1;
-    place_chunk(data_with_halos, rows + 2, cols + 2, recv_halo, from, to);
-
-    // Halo down - Send down, receive up
-    int from_hdwn[] = {0, rows - 1};
-    int to_hdwn[] = {cols - 1, rows - 1};
-    uint8_t* halo_down = get_chunk(data, rows, cols, from_hdwn, to_hdwn);
-    if(rank == 1) {
-        MPI_Send(halo_down, cols, MPI_UINT8_T, rank + 1, DATA_TAG, MPI_COMM_WORLD);
-        memset(recv_halo, 0, sizeof(uint8_t) * cols);
-    }
-    else if(rank == nworkers) {
-        MPI_Recv(recv_halo, cols, MPI_UINT8_T, rank - 1, DATA_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-    }
-    else {
-        MPI_Sendrecv(halo_down, cols, MPI_UINT8_T, rank + 1, DATA_TAG,
-                    recv_halo, cols, MPI_UINT8_T, rank - 1, DATA_TAG,
-                    MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-    }
-    free(halo_down);
-
-    from[0] = 1; from[1] = 0;
-    to[0] = cols; to[1] = 0;
-    place_chunk(data_with_halos, rows + 2, cols + 2, recv_halo, from, to);
-
-    updater(data_with_halos, rows + 2, cols + 2);
-
-
-    MPI_Barrier(MPI_COMM_WORLD); // Wait for updater
-
-
-    free(data);
-    from[0] = 1; from[1] = 1;
-    to[0] = cols; to[1] = rows;
-    data = get_chunk(data_with_halos, rows + 2, cols + 2, from, to);
-
-    free(data_with_halos);
-
-    MPI_Send(data, rows * cols, MPI_UINT8_T, 0, DATA_TAG, MPI_COMM_WORLD);
-
-    free(data);
-    free(recv_halo);
-}
-
-
-void worker_parallel_2d(int rank, int nworkers, int workers_x) {
-    int rows = -1, cols = -1;
-    int workers_y = nworkers / workers_x;
-    
-    MPI_Recv(&rows, 1, MPI_INT, 0, HEADER_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-    
-    if(_ldebug) {
-        printf("[%d]: Received rows from master: %d\n", rank, rows);
-        fflush(stdout);
-    }
-    
-    MPI_Recv(&cols, 1, MPI_INT, 0, HEADER_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-    
-    if(_ldebug) {
-        printf("[%d]: Received cols from master: %d\n", rank, cols);
-        fflush(stdout);
-    }
-    
-    uint8_t* data = calloc(rows * cols, sizeof(uint8_t));
-    if(!data) {
-        perror("Failed to allocate space for data in worker (1D)");
-        exit(errno);
-    }
-    MPI_Recv(data, rows * cols, MPI_UINT8_T, 0, HEADER_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-    
-    if(_ldebug) {
-        printf("[%d]: Received data from master: %d (len)\n", rank, rows * cols);
-        fflush(stdout);
-    }
-
-
-    solver(data, rows, cols);
-
-
-    MPI_Barrier(MPI_COMM_WORLD); // Wait for solver
-
-
-    uint8_t* data_with_halos = calloc((rows + 2) * (cols + 2), sizeof(uint8_t));
-    if(!data_with_halos) {
-        perror("Error allocating space for halos");
-        exit(errno);
-    }
-    int from[] = {1, 1};
-    int to[] = {cols, rows};
-
-    place_chunk(data_with_halos, rows + 2, cols + 2, data, from, to);
-
-    // Halos
-    uint8_t* recv_halo_row = calloc(cols, sizeof(uint8_t));
-    if(!recv_halo_row) {
-        perror("Error allocating memory for halo row");
-        exit(errno);
-    }
-
-    uint8_t* recv_halo_col = calloc(rows, sizeof(uint8_t));
-    if(!recv_halo_col) {
-        perror("Error allocating memory for halo col");
-        exit(errno);
-    }
-
-    // Determine if area is at edge
-    int is_on_first_row = rank <= workers_x ? 1 : 0;
-    int is_on_last_row = rank > workers_x * (workers_y - 1) ? 1 : 0;
-    int is_on_first_col = rank % workers_x == 1 ? 1 : 0;
-    int is_on_last_col = rank % workers_x == 0 ? 1 : 0;
-
-    // Halo up - Send up, receive down
-    int from_hup[] = {0, 0};
-    int to_hup[] = {cols - 1, 0};
-    uint8_t* halo_up = get_chunk(data, rows, cols, from_hup, to_hup);
-    if(is_on_first_row) {
-        MPI_Recv(recv_halo_row, cols, MPI_UINT8_T, rank + workers_x, DATA_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-    }
-    else if(is_on_last_row) {
-        MPI_Send(halo_up, cols, MPI_UINT8_T, rank - workers_x, DATA_TAG, MPI_COMM_WORLD);
-        memset(recv_halo_row, 0, sizeof(uint8_t) * cols);
-    }
-    else {
-        MPI_Sendrecv(halo_up, cols, MPI_UINT8_T, rank - workers_x, DATA_TAG,
-                    recv_halo_row, cols, MPI_UINT8_T, rank + workers_x, DATA_TAG,
-                    MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-    }
-    free(halo_up);
-
-    from[0] = 1; from[1] = rows + 1;
-    to[0] = cols; to[1] = rows + 1;
-    place_chunk(data_with_halos, rows + 2, cols + 2, recv_halo_row, from, to);
-
-    // Halo down - Send down, receive up
-    int from_hdwn[] = {0, rows - 1};
-    int to_hdwn[] = {cols - 1, rows - 1};
-    uint8_t* halo_dwn = get_chunk(data, rows, cols, from_hdwn, to_hdwn);
-    if(is_on_first_row) {
-        MPI_Send(halo_dwn, cols, MPI_UINT8_T, rank + workers_x, DATA_TAG, MPI_COMM_WORLD);
-        memset(recv_halo_row, 0, sizeof(uint8_t) * cols);
-    }
-    else if(is_on_last_row) {
-        MPI_Recv(recv_halo_row, cols, MPI_UINT8_T, rank - workers_x, DATA_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-    }
-    else {
-        MPI_Sendrecv(halo_dwn, cols, MPI_UINT8_T, rank + workers_x, DATA_TAG,
-                    recv_halo_row, cols, MPI_UINT8_T, rank - workers_x, DATA_TAG,
-                    MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-    }
-    free(halo_dwn);
-
-    from[0] = 1; from[1] = 0;
-    to[0] = cols; to[1] = 0;
-    place_chunk(data_with_halos, rows + 2, cols + 2, recv_halo_row, from, to);
-
-    // Halo left - Send left, receive right
-    int from_hlft[] = {0, 0};
-    int to_hlft[] = {0, rows - 1};
-    uint8_t* halo_lft = get_chunk(data, rows, cols, from_hlft, to_hlft);
-    if(is_on_first_col) {
-        MPI_Recv(recv_halo_col, rows, MPI_UINT8_T, rank + 1, DATA_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-    }
-    else if(is_on_last_col) {
-        MPI_Send(halo_lft, rows, MPI_UINT8_T, rank - 1, DATA_TAG, MPI_COMM_WORLD);
-        memset(recv_halo_col, 0, sizeof(uint8_t) * rows);
-    }
-    else {
-        MPI_Sendrecv(halo_lft, rows, MPI_UINT8_T, rank - 1, DATA_TAG,
-                    recv_halo_col, rows, MPI_UINT8_T, rank + 1, DATA_TAG,
-                    MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-    }
-    free(halo_lft);
-
-    from[0] = cols + 1; from[1] = 1;
-    to[0] = cols + 1; to[1] = rows;
-    place_chunk(data_with_halos, rows + 2, cols + 2, recv_halo_col, from, to);
-
-    // Halo right - Send right, receive left
-    int from_hrgt[] = {cols - 1, 0};
-    int to_hrgt[] = {cols - 1, rows - 1};
-    uint8_t* halo_rgt = get_chunk(data, rows, cols, from_hrgt, to_hrgt);
-    if(is_on_first_col) {
-        MPI_Send(halo_rgt, rows, MPI_UINT8_T, rank + 1, DATA_TAG, MPI_COMM_WORLD);
-        memset(recv_halo_col, 0, sizeof(uint8_t) * rows);
-    }
-    else if(is_on_last_col) {
-        MPI_Recv(recv_halo_col, rows, MPI_UINT8_T, rank - 1, DATA_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-    }
-    else {
-        MPI_Sendrecv(halo_rgt, rows, MPI_UINT8_T, rank + 1, DATA_TAG,
-                    recv_halo_col, rows, MPI_UINT8_T, rank - 1, DATA_TAG,
-                    MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-    }
-    free(halo_rgt);
-
-    from[0] = 0; from[1] = 1;
-    to[0] = 0; to[1] = rows;
-    place_chunk(data_with_halos, rows + 2, cols + 2, recv_halo_col, from, to);
-
-    updater(data_with_halos, rows + 2, cols + 2);
-
-
-    MPI_Barrier(MPI_COMM_WORLD); // Wait for updater
-
-
-    free(data);
-    from[0] = 1; from[1] = 1;
-    to[0] = cols; to[1] = rows;
-    data = get_chunk(data_with_halos, rows + 2, cols + 2, from, to);
-
-    free(data_with_halos);
-
-    MPI_Send(data, rows * cols, MPI_UINT8_T, 0, DATA_TAG, MPI_COMM_WORLD);
-
-    free(data);
-    free(recv_halo_row);
-    free(recv_halo_col);
-}
-
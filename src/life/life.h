@@ -1,38 +1,43 @@
 #ifndef _LIFE
 #define _LIFE
 
+#include <stdio.h>
 #include <stdint.h>
 
+#include "arena.h"
+#include "rule.h"
+#include "dmap.h"
+
 #define IN_CHUNK 1024
 #define OUT_DIR "outputs"
 
 /* Constants */
+// Von Neumann rules keep one bit per neighbour, Moore rules the count of alive neighbours in the same 4 bits (see rule.h)
 #define CELL_ALIVE  0b00000001
 #define CELL_WEST   0b00000010
 #define CELL_NORTH  0b00000100
 #define CELL_EAST   0b00001000
 #define CELL_SOUTH  0b00010000
 
-#define PARALLEL_1D_TAG 69
-#define PARALLEL_2D_TAG 420
-#define WAIT_TAG        80085
 #define DONE_TAG        1337
+#define BATCH_TAG       7777
 
 #define HEADER_TAG      0
 #define DATA_TAG        1
+#define REGION_TAG      2
 
 #define MINIMUM_1D      2
 #define MINIMUM_2D      4
 
 /* Macros */
 // 0x01 if active / has neighbour, 0x00 otherwise
-#define IS_ALIVE(cell) (cell & CELL_ALIVE)
+#define IS_ALIVE(cell) ((cell) & CELL_ALIVE)
 #define HAS_WEST(cell) ((cell & CELL_WEST) >> 1)
 #define HAS_NORTH(cell) ((cell & CELL_NORTH) >> 2)
 #define HAS_EAST(cell) ((cell & CELL_EAST) >> 3)
 #define HAS_SOUTH(cell) ((cell & CELL_SOUTH) >> 4)
 
-// Used a karnough map
+// Used a karnough map. This is the default rule (B3/S23V), the kernels use its table in rule.c
 // Minterms: 7,11,13,14,15,19,21,22,23,25,26,27,28,29
 #define MAKE_ALIVE(cell) ((~HAS_SOUTH(cell) & HAS_EAST(cell) & HAS_NORTH(cell) & HAS_WEST(cell)) | (HAS_SOUTH(cell) & ~HAS_EAST(cell) & HAS_NORTH(cell) & HAS_WEST(cell)) | (HAS_SOUTH(cell) & HAS_EAST(cell) & ~HAS_NORTH(cell) & HAS_WEST(cell)) | (HAS_SOUTH(cell) & HAS_EAST(cell) & HAS_NORTH(cell) & ~HAS_WEST(cell)) | (~HAS_SOUTH(cell) & HAS_NORTH(cell) & HAS_WEST(cell) & IS_ALIVE(cell)) | (~HAS_SOUTH(cell) & HAS_EAST(cell) & HAS_WEST(cell) & IS_ALIVE(cell)) | (~HAS_SOUTH(cell) & HAS_EAST(cell) & HAS_NORTH(cell) & IS_ALIVE(cell)) | (HAS_SOUTH(cell) & ~HAS_EAST(cell) & HAS_WEST(cell) & IS_ALIVE(cell)) | (HAS_SOUTH(cell) & ~HAS_EAST(cell) & HAS_NORTH(cell) & IS_ALIVE(cell)) | (HAS_SOUTH(cell) & HAS_EAST(cell) & ~HAS_NORTH(cell) & IS_ALIVE(cell)))
 
@@ -49,20 +54,35 @@ typedef struct _area_t {
     int to[2];
 } area_t;
 
+// Population of one generation and how it changed. The box of the alive cells is in the padded universe, empty (`min > max`) once everything is dead
+typedef struct _gen_stats_t {
+    long long population;
+    long long births, deaths;
+    int min_x, min_y;
+    int max_x, max_y;
+} gen_stats_t;
+
 /* Utils */
 // void swap(void*, void*);
 void swapp(void** a, void** b);
 int mequal(uint8_t* m1, uint8_t* m2, int rows, int cols);
+long long population(uint8_t* cells, int rows, int cols);
 
 void print_area(area_t area);
 void print_areas(area_t* areas, int len);
+// Puts the cells `a` and `b` have in common in `out`. Returns 0 if they have none
+int area_meet(const area_t* a, const area_t* b, area_t* out);
 
 void print_bin(uint8_t num);
 void print_binc(uint8_t num, char alive, char n_alive);
 void mprint_binc(uint8_t* mat, int rows, int cols, char alive, char n_alive);
 
 uint8_t* get_chunk(uint8_t* buffer, int rows, int columns, int* start, int* end);
+void copy_chunk(uint8_t* chunk, uint8_t* buffer, int rows, int columns, int* start, int* end);
 void place_chunk(uint8_t* buffer, int rows, int columns, uint8_t* chunk, int* start, int* end);
+void clear_ring(uint8_t* buffer, int rows, int columns);
+void wrap_ring(uint8_t* buffer, int rows, int columns);
+void wrap_cols(uint8_t* buffer, int rows, int columns);
 
 void validate_path(char* path);
 char* get_output_path(char* in_name, char* type);
@@ -70,9 +90,26 @@ char* get_output_path(char* in_name, char* type);
 /* I/O */
 uint8_t* fload_gen(char* in_file_name, int* rows, int* columns);
 void fwrite_gen(char* out_file_name, uint8_t* cells, int rows, int cols, float t_elapsed);
+// Row by row versions, for files streamed in bands (see stream.h)
+FILE* fopen_gen(char* in_file_name, int* rows, int* columns);
+FILE* fopen_result(char* out_file_name, float t_elapsed);
+void fread_rows(FILE* in_file, uint8_t* cells, int rows, int columns, int row_len);
+// Same as `fread_rows(...)`, without exiting: returns 0, -1 if the file ends first, or the first character that is not a cell
+int fparse_rows(FILE* in_file, uint8_t* cells, int rows, int columns, int row_len);
+// Same as `fload_gen(...)`, returning NULL instead of exiting when the file cannot be opened, is not a generation or does not fit in memory (for the library, see engine.h)
+// NOTE: Do NOT forget to free the returned pointer with `mem_free(...)`
+uint8_t* fparse_gen(char* in_file_name, int* rows, int* columns);
+void fwrite_rows(FILE* out_file, uint8_t* cells, int rows, int cols, int row_len);
+// Writes `rows * cols` cells, `row_len` apart, as a generation file (dimensions, then the rows), so it can be the input of another run
+void fwrite_region(char* out_file_name, uint8_t* cells, int rows, int cols, int row_len);
+uint8_t* fload_result(char* in_file_name, int rows, int cols, float* t_elapsed);
+// Golden hashes: one `<input> <generation> <hash>` entry per line
+int fload_golden(char* golden_file_name, char* key, int gens, uint64_t* hash);
+void fwrite_golden(char* golden_file_name, char* key, int gens, uint64_t hash);
+char** fload_manifest(char* manifest_name, int* count);
 
 /* Work */
-// In place solver, using the per cell data and the two above macros
+// In place solver, using the per cell data and the table of the current rule (see `rule_set(...)`)
 /*
     Args:
         uint8_t*: Matrix array chunk
@@ -81,23 +118,49 @@ void fwrite_gen(char* out_file_name, uint8_t* cells, int rows, int cols, float t
 */
 void solver(uint8_t* cells, int rows, int cols);
 void usolver(uint8_t* cells, int rows, int cols);
-// Updater that works similarly to the updates done in the `fload_gen(...)` method (life.c: 74)
+// Updater: recomputes the neighbour data of the cells from the alive bits around them, for the neighbourhood of the current rule
 /*
     Args:
         uint8_t*: Matrix array chunk
         int: rows of given matrix chunk
         int: columns of given matrix chunk
         **NOTE:**:
-            - If the starting position is (1, 1) this is the target cell, and it will work with cells (0, 1) and (1, 0).
-            - So for a call `updater(arr, (x0, y0), (x1, y1))` the arr will have to be a box with the boundries `rect(x0 - 1, y0 - 1, x1, y1)`
+            - The outer ring of the chunk is only read (halos or padding), so for a block `rect(x0, y0, x1, y1)` the arr will have to be a box with the boundries `rect(x0 - 1, y0 - 1, x1 + 1, y1 + 1)`
+            - Moore rules read the corners of that box too
 */
 void updater(uint8_t* cells, int rows, int cols);
-void next_gen(uint8_t* buffer, int buff_rows, int buff_cols);
+void next_gen(uint8_t* buffer, int buff_rows, int buff_cols, int torus);
+
+/* Hashing */
+// Zobrist style hash: the hash of a state is the XOR of the keys of all its alive cells. Keys depend on the global (padded) position only, so chunk hashes can be combined with XOR regardless of the decomposition
+uint64_t zobrist(int x, int y);
+// Full hash of a chunk whose (0, 0) cell is at `start` (int[2], x, y) in the padded universe
+uint64_t ghash(uint8_t* cells, int rows, int cols, int* start);
+// Same as the solver, but returns the XOR of the keys of the cells that flipped, so `new_hash = old_hash ^ hsolver(...)`
+uint64_t hsolver(uint8_t* cells, int rows, int cols, int* start);
+// Same as `next_gen(...)`, returning the hash delta of the generation
+uint64_t hnext_gen(uint8_t* buffer, int buff_rows, int buff_cols, int torus);
+
+/* Statistics */
+// Empty statistics (nothing alive, empty box), to accumulate into
+void stats_clear(gen_stats_t* stats);
+// Adds the statistics of another part of the same generation
+void stats_merge(gen_stats_t* stats, const gen_stats_t* other);
+// Same as `hsolver(...)`, also adding the population after the solver, the births, the deaths and the box of the chunk to `stats`, and its alive cells to the blocks of `map`, in the same pass. Either can be NULL
+uint64_t ssolver(uint8_t* cells, int rows, int cols, int* start, gen_stats_t* stats, dmap_t* map);
+// Same as `hnext_gen(...)`, with the statistics of the generation added to `stats` and its alive cells to `map` (either can be NULL)
+uint64_t snext_gen(uint8_t* buffer, int buff_rows, int buff_cols, int torus, gen_stats_t* stats, dmap_t* map);
+// Same as `solver(...)` (`hsolver(...)` if `hash`), adding the alive cells of the chunk to the blocks of `map` row by row, while each row is in cache
+uint64_t msolver(uint8_t* cells, int rows, int cols, int* start, int hash, dmap_t* map);
+// Same as `next_gen(...)` (`hnext_gen(...)` if `hash`), with the alive cells of the generation added to `map`
+uint64_t mnext_gen(uint8_t* buffer, int buff_rows, int buff_cols, int torus, int hash, dmap_t* map);
+// Time series of a run, one CSV line per generation from generation 1. Boxes are written in the universe without padding, -1 when empty
+void fwrite_stats(char* stats_file_name, gen_stats_t* stats, int gens);
 
 area_t* create_jobs_1d(int rows, int columns, int workers, int* job_cnt);
 area_t* create_jobs_2d(int rows, int columns, int workers, int* job_cnt, int* workers_x);
-
-void worker_parallel_1d(int rank, int nworkers);
-void worker_parallel_2d(int rank, int nworkers, int workers_x);
+area_t* create_jobs_grid(int rows, int columns, int workers_x, int workers_y, int* job_cnt);
+// Same as `create_jobs_grid(...)`, into the `workers_x * workers_y` areas of `blocks`
+void fill_jobs_grid(area_t* blocks, int rows, int columns, int workers_x, int workers_y);
 
 #endif
\ No newline at end of file
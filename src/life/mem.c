@@ -0,0 +1,175 @@
+#include "mem.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+// Placed right before every pointer handed out, so `mem_free(...)` knows how to give the memory back
+typedef struct _mem_header_t {
+    void* base; // what the allocator returned, up to `MEM_HEADER - 1` bytes before the header on the heap
+    size_t length;
+    int backing;
+} mem_header_t;
+
+// Keeps the data cache line aligned
+#define MEM_HEADER 64
+
+#define MEM_HEAP 0
+#define MEM_SMALL_PAGES 1
+#define MEM_THP 2
+#define MEM_HUGETLB 3
+
+static int mem_pages = MEM_PAGES_THP;
+
+
+void mem_set_pages(int pages) {
+    mem_pages = pages;
+}
+
+
+int mem_get_pages() {
+    return mem_pages;
+}
+
+
+#ifdef __linux__
+// Maps `length` bytes with the requested backing, falling back to smaller pages. Returns NULL if nothing could be mapped
+static void* mem_map(size_t length, int* backing) {
+    void* base = MAP_FAILED;
+
+    #ifdef MAP_HUGETLB
+    if(mem_pages == MEM_PAGES_EXPLICIT) {
+        size_t huge_length = (length + MEM_LARGE - 1) / MEM_LARGE * MEM_LARGE;
+        base = mmap(NULL, huge_length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if(base != MAP_FAILED) {
+            *backing = MEM_HUGETLB;
+            return base;
+        }
+    }
+    #endif
+
+    base = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if(base == MAP_FAILED) return NULL;
+
+    *backing = MEM_SMALL_PAGES;
+    #ifdef MADV_HUGEPAGE
+    if(mem_pages != MEM_PAGES_NONE && madvise(base, length, MADV_HUGEPAGE) == 0) {
+        *backing = MEM_THP;
+    }
+    #endif
+
+    return base;
+}
+#endif
+
+
+void* mem_alloc(size_t bytes) {
+    void* ptr = mem_try_alloc(bytes);
+    if(!ptr) {
+        perror("Error allocating buffer");
+        exit(errno);
+    }
+    return ptr;
+}
+
+
+void* mem_try_alloc(size_t bytes) {
+    size_t length = MEM_HEADER + bytes;
+    void* base = NULL;
+    int backing = MEM_HEAP;
+
+    #ifdef __linux__
+    if(bytes >= MEM_LARGE) {
+        base = mem_map(length, &backing);
+        if(backing == MEM_HUGETLB) {
+            length = (length + MEM_LARGE - 1) / MEM_LARGE * MEM_LARGE;
+        }
+    }
+    #endif
+
+    // The heap (everything off Linux) is aligned by hand on top of `malloc(...)`, except with the Microsoft C runtime, which has its own aligned heap and no `aligned_alloc(...)`
+    uint8_t* start = base;
+    if(!base) {
+        backing = MEM_HEAP;
+        #ifdef _WIN32
+        base = _aligned_malloc(length, MEM_HEADER);
+        if(!base) return NULL;
+        start = base;
+        #else
+        base = malloc(length + MEM_HEADER - 1);
+        if(!base) return NULL;
+        start = (uint8_t*) (((uintptr_t) base + MEM_HEADER - 1) / MEM_HEADER * MEM_HEADER);
+        #endif
+    }
+
+    // First touch: the kernel places each page on the node of the process that writes it first
+    memset(start, 0, length);
+
+    mem_header_t* header = (mem_header_t*) start;
+    header->base = base;
+    header->length = length;
+    header->backing = backing;
+
+    return start + MEM_HEADER;
+}
+
+
+void mem_free(void* ptr) {
+    if(!ptr) return;
+
+    mem_header_t* header = (mem_header_t*) ((uint8_t*) ptr - MEM_HEADER);
+
+    #ifdef __linux__
+    if(header->backing != MEM_HEAP) {
+        munmap(header->base, header->length);
+        return;
+    }
+    #endif
+
+    #ifdef _WIN32
+    _aligned_free(header->base);
+    #else
+    free(header->base);
+    #endif
+}
+
+
+const char* mem_backing(void* ptr) {
+    mem_header_t* header = (mem_header_t*) ((uint8_t*) ptr - MEM_HEADER);
+
+    switch(header->backing) {
+        case MEM_SMALL_PAGES:
+            return "4 KB pages";
+        case MEM_THP:
+            return "transparent huge pages (madvise)";
+        case MEM_HUGETLB:
+            return "explicit huge pages";
+        default:
+            return "heap";
+    }
+}
+
+
+void mem_where(int* cpu, int* node) {
+    *cpu = -1;
+    *node = -1;
+
+    #if defined(__linux__) && defined(SYS_getcpu)
+    unsigned int c, n;
+    if(syscall(SYS_getcpu, &c, &n, NULL) == 0) {
+        *cpu = (int) c;
+        *node = (int) n;
+    }
+    #endif
+}
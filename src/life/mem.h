@@ -0,0 +1,34 @@
+#ifndef _MEM
+#define _MEM
+
+#include <stddef.h>
+
+/* Constants */
+// Page backing of the large buffers (`--hugepages`)
+#define MEM_PAGES_NONE     0 // regular 4 KB pages
+#define MEM_PAGES_THP      1 // transparent huge pages, asked for with `madvise(...)`
+#define MEM_PAGES_EXPLICIT 2 // `MAP_HUGETLB` from the reserved pool, transparent huge pages if it is empty
+
+// Buffers from this size on are mapped on their own and can get huge pages, smaller ones come from the heap
+#define MEM_LARGE (2 << 20)
+
+/* Allocation */
+// Sets the backing asked for large buffers, for every later `mem_alloc(...)` of this process
+void mem_set_pages(int pages);
+int mem_get_pages();
+
+// Zeroed, cache line aligned buffer. Every page is written here, so it ends up on the NUMA node of the calling process (first touch)
+// NOTE: Do NOT forget to free the returned pointer with `mem_free(...)`
+void* mem_alloc(size_t bytes);
+// Same, returning NULL instead of exiting when there is no memory left (for the library, see engine.h)
+// NOTE: Do NOT forget to free the returned pointer with `mem_free(...)`
+void* mem_try_alloc(size_t bytes);
+void mem_free(void* ptr);
+// Name of the backing `ptr` actually got: "heap", "4 KB pages", "transparent huge pages (madvise)" or "explicit huge pages"
+const char* mem_backing(void* ptr);
+
+/* Placement */
+// CPU and NUMA node the calling process runs on. -1 if unknown
+void mem_where(int* cpu, int* node);
+
+#endif
@@ -0,0 +1,219 @@
+#include "ooc.h"
+#include "mem.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <stdint.h>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+
+
+#ifdef __linux__
+// Bytes of the rows `first` to `first + count - 1`, starting on a page. Returns 0 if there are no such rows
+static int ooc_range(ooc_t* ooc, int first, int count, size_t* from, size_t* length) {
+    first = MAX(first, 0);
+    count = MIN(count, ooc->rows - first);
+    if(count <= 0) return 0;
+
+    size_t page = sysconf(_SC_PAGESIZE);
+    *from = (size_t) first * ooc->cols / page * page;
+    *length = (size_t) (first + count) * ooc->cols - *from;
+    return 1;
+}
+
+
+// `madvise(...)` over some rows of a generation. Advice is only a hint, so failures are not errors
+static void ooc_advise(ooc_t* ooc, uint8_t* map, int first, int count, int advice) {
+    size_t from, length;
+    if(ooc_range(ooc, first, count, &from, &length)) {
+        madvise(map + from, length, advice);
+    }
+}
+
+
+// Starts writing some rows of a generation back to its file, without waiting for it
+static void ooc_flush(ooc_t* ooc, uint8_t* map, int first, int count) {
+    size_t from, length;
+    if(ooc_range(ooc, first, count, &from, &length)) {
+        msync(map + from, length, MS_ASYNC);
+    }
+}
+
+
+// Solves (if `solve`) and updates the current generation into the next one, band by band, then swaps them
+static uint64_t ooc_pass(ooc_t* ooc, int solve, int hash, gen_stats_t* stats, dmap_t* map) {
+    uint8_t* src = ooc->maps[0];
+    uint8_t* dst = ooc->maps[1];
+    size_t row = ooc->cols;
+    int last_row = ooc->rows - 2;
+    int released = 0; // rows of both files let go so far
+    uint64_t delta = 0;
+
+    for(int first = 1; first <= last_row; first += ooc->band_rows) {
+        int n = MIN(ooc->band_rows, last_row - first + 1);
+
+        ooc_advise(ooc, src, first + n, ooc->band_rows + 1, MADV_WILLNEED);
+
+        // The rows around the band: the dead ring, or the opposite edges on a torus
+        int above = first - 1, below = first + n;
+        if(ooc->torus) {
+            if(above == 0) above = last_row;
+            if(below == last_row + 1) below = 1;
+        }
+        memcpy(ooc->local, src + above * row, row * sizeof(uint8_t));
+        memcpy(ooc->local + row, src + first * row, n * row * sizeof(uint8_t));
+        memcpy(ooc->local + (n + 1) * row, src + below * row, row * sizeof(uint8_t));
+
+        if(solve) {
+            // Only the flips of the band's own rows count, the rows around it belong to other bands
+            solver(ooc->local, 1, ooc->cols);
+            solver(ooc->local + (n + 1) * row, 1, ooc->cols);
+            int start[] = {0, first};
+            if(stats) {
+                delta ^= ssolver(ooc->local + row, n, ooc->cols, start, stats, map);
+            }
+            else if(map) {
+                delta ^= msolver(ooc->local + row, n, ooc->cols, start, hash, map);
+            }
+            else if(hash) {
+                delta ^= hsolver(ooc->local + row, n, ooc->cols, start);
+            }
+            else {
+                solver(ooc->local + row, n, ooc->cols);
+            }
+        }
+
+        if(ooc->torus) {
+            wrap_cols(ooc->local, n + 2, ooc->cols);
+        }
+        updater(ooc->local, n + 2, ooc->cols);
+        if(ooc->torus) {
+            clear_ring(ooc->local, n + 2, ooc->cols);
+        }
+
+        memcpy(dst + first * row, ooc->local + row, n * row * sizeof(uint8_t));
+
+        // The written rows start going to disk, and neither file needs the rows before the next band's row above any more
+        ooc_flush(ooc, dst, first, n);
+        ooc_advise(ooc, src, released, first + n - 1 - released, MADV_DONTNEED);
+        ooc_advise(ooc, dst, released, first + n - 1 - released, MADV_DONTNEED);
+        released = first + n - 1;
+    }
+
+    swapp((void**) &ooc->maps[0], (void**) &ooc->maps[1]);
+    swapp((void**) &ooc->paths[0], (void**) &ooc->paths[1]);
+    int fd = ooc->fds[0];
+    ooc->fds[0] = ooc->fds[1];
+    ooc->fds[1] = fd;
+
+    return delta;
+}
+#endif
+
+
+ooc_t* ooc_create(char* dir, int rows, int columns, int torus) {
+#ifdef __linux__
+    ooc_t* ooc = malloc(sizeof(ooc_t));
+    if(!ooc) {
+        perror("Error allocating out of core universe");
+        exit(errno);
+    }
+
+    ooc->rows = rows + 2;
+    ooc->cols = columns + 2;
+    ooc->band_rows = OOC_BAND_ROWS(columns);
+    ooc->torus = torus;
+    ooc->length = (size_t) ooc->rows * ooc->cols;
+
+    for(int i = 0; i < 2; i++) {
+        ooc->paths[i] = malloc(strlen(dir) + 64);
+        if(!ooc->paths[i]) {
+            perror("Error allocating out of core file name");
+            exit(errno);
+        }
+        sprintf(ooc->paths[i], "%s/ooc_%d_%d.bin", dir, (int) getpid(), i);
+
+        // A new file reads as zeros without taking disk space, so both generations start dead, ring included
+        ooc->fds[i] = open(ooc->paths[i], O_RDWR | O_CREAT | O_TRUNC, 0600);
+        if(ooc->fds[i] < 0 || ftruncate(ooc->fds[i], ooc->length) != 0) {
+            perror("Error creating out of core file");
+            exit(errno);
+        }
+
+        ooc->maps[i] = mmap(NULL, ooc->length, PROT_READ | PROT_WRITE, MAP_SHARED, ooc->fds[i], 0);
+        if(ooc->maps[i] == MAP_FAILED) {
+            perror("Error mapping out of core file");
+            exit(errno);
+        }
+        madvise(ooc->maps[i], ooc->length, MADV_SEQUENTIAL);
+    }
+
+    ooc->local = mem_alloc((size_t) (ooc->band_rows + 2) * ooc->cols * sizeof(uint8_t));
+
+    return ooc;
+#else
+    printf("Out of core runs need Linux (memory mapped files)\n");
+    fflush(stdout);
+    exit(-1);
+#endif
+}
+
+
+void ooc_free(ooc_t* ooc) {
+#ifdef __linux__
+    if(!ooc) return;
+
+    for(int i = 0; i < 2; i++) {
+        munmap(ooc->maps[i], ooc->length);
+        close(ooc->fds[i]);
+        unlink(ooc->paths[i]);
+        free(ooc->paths[i]);
+    }
+    mem_free(ooc->local);
+    free(ooc);
+#endif
+}
+
+
+void ooc_load(ooc_t* ooc, FILE* in_file, uint64_t* hash) {
+#ifdef __linux__
+    int last_row = ooc->rows - 2;
+
+    if(hash) *hash = 0;
+
+    // Straight into the file, one band at a time
+    for(int first = 1; first <= last_row; first += ooc->band_rows) {
+        int n = MIN(ooc->band_rows, last_row - first + 1);
+        uint8_t* band = ooc->maps[0] + (size_t) first * ooc->cols;
+
+        fread_rows(in_file, band + 1, n, ooc->cols - 2, ooc->cols);
+        if(hash) {
+            int start[] = {0, first};
+            *hash ^= ghash(band, n, ooc->cols, start);
+        }
+    }
+
+    // Neighbour data, the same as the loaders give (see `fload_gen(...)`)
+    ooc_pass(ooc, 0, 0, NULL, NULL);
+#endif
+}
+
+
+uint64_t ooc_step(ooc_t* ooc, int hash, gen_stats_t* stats, dmap_t* map) {
+#ifdef __linux__
+    return ooc_pass(ooc, 1, hash, stats, map);
+#else
+    return 0;
+#endif
+}
+
+
+void ooc_write(ooc_t* ooc, FILE* out_file) {
+    fwrite_rows(out_file, ooc->maps[0], ooc->rows, ooc->cols, ooc->cols);
+}
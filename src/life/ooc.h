@@ -0,0 +1,50 @@
+#ifndef _OOC
+#define _OOC
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#include "life.h"
+
+/* Constants */
+// Cells of one band in memory. Everything else stays in the files (and the page cache)
+#define OOC_BAND_SIZE (16 << 20)
+
+/* Macros */
+// Rows of the bands of a universe `columns` cells wide (without padding)
+#define OOC_BAND_ROWS(columns) MAX(1, OOC_BAND_SIZE / ((columns) + 2))
+
+/* Types */
+// Universe too large for memory: the current and the next generation are memory mapped files, solved band by band
+typedef struct _ooc_t {
+    int rows, cols; // padded universe
+    int band_rows;
+    int torus;
+
+    char* paths[2];
+    int fds[2];
+    uint8_t* maps[2]; // current and next generation, `rows * cols` cells each
+    size_t length;
+
+    uint8_t* local; // a band and the rows above and below it
+} ooc_t;
+
+/* Out of core */
+// Creates the 2 generation files in the directory `dir`, which has to exist (dead, sparse), and maps them. Linux only
+// NOTE: Do NOT forget to free the returned pointer with `ooc_free(...)`, which also removes the files
+ooc_t* ooc_create(char* dir, int rows, int columns, int torus);
+void ooc_free(ooc_t* ooc);
+// Parses the rows of `in_file` (see `fopen_gen(...)`) into the current generation and computes its neighbour data. The hash of the universe goes to `hash`, unless NULL
+void ooc_load(ooc_t* ooc, FILE* in_file, uint64_t* hash);
+// Advances the universe one generation, band by band. Returns the hash delta of the generation if `hash`, 0 otherwise. Its statistics are added to `stats` and its alive cells to `map`, unless NULL
+/*
+    **NOTE:**:
+        - Each band is copied to memory with the rows above and below it (the opposite edges on a torus), solved and updated there with the kernels of `next_gen(...)`, and copied into the next generation
+        - The next band is read ahead (`MADV_WILLNEED`) while one is solved, and the pages already used are let go, so the disk streams instead of faulting page by page
+*/
+uint64_t ooc_step(ooc_t* ooc, int hash, gen_stats_t* stats, dmap_t* map);
+// Writes the current generation the way `fwrite_gen(...)` does, padding included
+void ooc_write(ooc_t* ooc, FILE* out_file);
+
+#endif
@@ -0,0 +1,71 @@
+#include "region.h"
+
+#include <stdio.h>
+
+
+int region_parse(char* spec, area_t* region) {
+    int x, y, width, height, read = 0;
+    if(sscanf(spec, "%d,%d,%d,%d%n", &x, &y, &width, &height, &read) != 4 || spec[read] != '\0') {
+        return -1;
+    }
+    if(x < 0 || y < 0 || width < 1 || height < 1) {
+        return -1;
+    }
+
+    *region = (area_t) {
+        from: {x + 1, y + 1},
+        to: {x + width, y + height}
+    };
+    return 0;
+}
+
+
+// `part` of a buffer of `rows * cols` cells that holds `holder` of the padded universe
+// NOTE: Do NOT forget to free the returned type with `MPI_Type_free(...)`
+static MPI_Datatype region_part(area_t* part, area_t* holder, int rows, int cols) {
+    int sizes[] = {rows, cols};
+    int subsizes[] = {part->to[1] - part->from[1] + 1, part->to[0] - part->from[0] + 1};
+    int starts[] = {part->from[1] - holder->from[1], part->from[0] - holder->from[0]};
+
+    MPI_Datatype type;
+    MPI_Type_create_subarray(2, sizes, subsizes, starts, MPI_ORDER_C, MPI_UINT8_T, &type);
+    MPI_Type_commit(&type);
+    return type;
+}
+
+
+void region_send(block_t* block, area_t* region, MPI_Comm comm) {
+    // The block with its ring
+    area_t holder = {
+        from: {block->origin[0] - block->ring[2], block->origin[1] - block->ring[0]},
+        to: {block->origin[0] + block->cols - 1 + block->ring[3], block->origin[1] + block->rows - 1 + block->ring[1]}
+    };
+    area_t own = {
+        from: {block->origin[0], block->origin[1]},
+        to: {block->origin[0] + block->cols - 1, block->origin[1] + block->rows - 1}
+    };
+
+    area_t part;
+    if(!area_meet(&own, region, &part)) return;
+
+    MPI_Datatype type = region_part(&part, &holder, block->rows_real, block->cols_real);
+    MPI_Send(block->cells, 1, type, 0, REGION_TAG, comm);
+    MPI_Type_free(&type);
+}
+
+
+void region_gather(area_t* region, uint8_t* cells, area_t* jobs, int job_cnt, MPI_Comm comm) {
+    MPI_Request requests[job_cnt];
+    int posted = 0;
+
+    for(int i = 0; i < job_cnt; i++) {
+        area_t part;
+        if(!area_meet(&jobs[i], region, &part)) continue;
+
+        MPI_Datatype type = region_part(&part, region, region->to[1] - region->from[1] + 1, region->to[0] - region->from[0] + 1);
+        MPI_Irecv(cells, 1, type, i + 1, REGION_TAG, comm, &requests[posted++]);
+        MPI_Type_free(&type);
+    }
+
+    MPI_Waitall(posted, requests, MPI_STATUSES_IGNORE);
+}
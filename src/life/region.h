@@ -0,0 +1,26 @@
+#ifndef _REGION
+#define _REGION
+
+#include <stdint.h>
+#include <mpi.h>
+
+#include "life.h"
+#include "block.h"
+
+/* Constants */
+// Regions of interest a run can extract (`--roi`)
+#define REGION_MAX 8
+
+/* Regions of interest */
+// Parses `<x>,<y>,<w>,<h>` (columns and rows from 0, without padding) into an area of the padded universe. Returns 0 on success, -1 if it is not a rectangle
+int region_parse(char* spec, area_t* region);
+// Worker: sends the cells of its block inside `region` (padded universe) straight from the block to the master, as one subarray. Nothing if they do not meet
+void region_send(block_t* block, area_t* region, MPI_Comm comm);
+// Master: receives `region` from the workers whose blocks it crosses (job `i` on rank `i + 1`) into `cells`, `width * height` cells of the region, each part straight to its place as a subarray
+/*
+    **NOTE:**:
+        - Only the workers that own a part of the region send anything, so the messages add up to the size of the region, whatever the size of the universe
+*/
+void region_gather(area_t* region, uint8_t* cells, area_t* jobs, int job_cnt, MPI_Comm comm);
+
+#endif
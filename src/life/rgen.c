@@ -0,0 +1,100 @@
+#include "rgen.h"
+#include "life.h"
+#include "mem.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <stdint.h>
+
+
+static inline void mulhilo32(uint32_t a, uint32_t b, uint32_t* hi, uint32_t* lo) {
+    uint64_t prod = (uint64_t) a * (uint64_t) b;
+    *hi = (uint32_t) (prod >> 32);
+    *lo = (uint32_t) prod;
+}
+
+
+// Philox4x32-10
+void philox4x32(const uint32_t ctr[4], const uint32_t key[2], uint32_t out[4]) {
+    uint32_t c0 = ctr[0], c1 = ctr[1], c2 = ctr[2], c3 = ctr[3];
+    uint32_t k0 = key[0], k1 = key[1];
+
+    for(int r = 0; r < PHILOX_ROUNDS; r++) {
+        uint32_t hi0, lo0, hi1, lo1;
+        mulhilo32(PHILOX_M0, c0, &hi0, &lo0);
+        mulhilo32(PHILOX_M1, c2, &hi1, &lo1);
+
+        c0 = hi1 ^ c1 ^ k0;
+        c1 = lo1;
+        c2 = hi0 ^ c3 ^ k1;
+        c3 = lo0;
+
+        k0 += PHILOX_W0;
+        k1 += PHILOX_W1;
+    }
+
+    out[0] = c0; out[1] = c1; out[2] = c2; out[3] = c3;
+}
+
+
+void rgen_area(
+    uint8_t* cells,
+    int rows,
+    int cols,
+    int* start, // int[2] position of cells[0] in the padded universe (x, y)
+    int grid_rows,
+    int grid_cols,
+    double density,
+    uint64_t seed,
+    int torus
+) {
+    uint32_t key[2] = {(uint32_t) seed, (uint32_t) (seed >> 32)};
+
+    // A cell is alive if its 32 bit draw falls under the threshold
+    uint64_t threshold = density <= 0 ? 0 : (density >= 1 ? (1ull << 32) : (uint64_t) (density * 4294967296.0));
+
+    for(int i = 0; i < rows; i++) {
+        int gy = torus ? RGEN_WRAP(start[1] + i, grid_rows) : start[1] + i;
+
+        // One Philox call covers 4 consecutive cells of the same row, so the draws are cached per block
+        uint32_t draws[4];
+        int cached_block = -1;
+
+        for(int j = 0; j < cols; j++) {
+            int gx = torus ? RGEN_WRAP(start[0] + j, grid_cols) : start[0] + j;
+            size_t idx = (size_t) i * cols + j;
+
+            if(gy < 1 || gy > grid_rows || gx < 1 || gx > grid_cols) {
+                cells[idx] = 0;
+                continue;
+            }
+
+            int block = (gx - 1) >> 2;
+            if(block != cached_block) {
+                uint32_t ctr[4] = {(uint32_t) block, (uint32_t) (gy - 1), 0, 0};
+                philox4x32(ctr, key, draws);
+                cached_block = block;
+            }
+
+            cells[idx] = (uint64_t) draws[(gx - 1) & 3] < threshold ? CELL_ALIVE : 0;
+        }
+    }
+
+    // Neighbour bits, same as after a regular generation
+    updater(cells, rows, cols);
+}
+
+
+// NOTE: Do NOT forget to free the returned pointer with `mem_free(...)`
+uint8_t* rgen_gen(int rows, int columns, double density, uint64_t seed) {
+    int rows_real = rows + 2;
+    int cols_real = columns + 2;
+
+    uint8_t* buffer = mem_alloc((size_t) rows_real * cols_real * sizeof(uint8_t));
+
+    int start[] = {0, 0};
+    rgen_area(buffer, rows_real, cols_real, start, rows, columns, density, seed, 0);
+
+    return buffer;
+}
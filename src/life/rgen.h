@@ -0,0 +1,45 @@
+#ifndef _RGEN
+#define _RGEN
+
+#include <stdint.h>
+
+/* Constants */
+// Philox4x32 round constants (Salmon et al., "Parallel random numbers: as easy as 1, 2, 3")
+#define PHILOX_M0   0xD2511F53u
+#define PHILOX_M1   0xCD9E8D57u
+#define PHILOX_W0   0x9E3779B9u
+#define PHILOX_W1   0xBB67AE85u
+#define PHILOX_ROUNDS 10
+
+#define RGEN_DEFAULT_DENSITY 0.5
+#define RGEN_DEFAULT_SEED    0
+
+/* Macros */
+// Position `g` of a padded torus of `n` cells per side inside the universe: the padding holds the opposite edge
+#define RGEN_WRAP(g, n) ((((g) - 1) % (n) + (n)) % (n) + 1)
+
+/* Random generation */
+// Counter based generator: the same (counter, key) pair always gives the same output, no state is kept
+void philox4x32(const uint32_t ctr[4], const uint32_t key[2], uint32_t out[4]);
+
+// Fills the alive bits of a chunk of the (padded) universe and computes the neighbour bits
+/*
+    Args:
+        uint8_t*: chunk to fill, `rows * cols` cells
+        int: rows of the chunk
+        int: columns of the chunk
+        int*: int[2] position of the chunk's (0, 0) cell inside the padded universe (x, y)
+        int: rows of the universe (without padding)
+        int: columns of the universe (without padding)
+        double: probability of a cell being alive
+        uint64_t: seed
+        int: whether the edges of the universe wrap around
+    **NOTE:**:
+        - Each cell only depends on its global position and the seed, so any decomposition of the universe gets the same cells
+        - Cells that fall on the padding ring (or outside the universe) are left dead, or drawn at their place across the opposite edge on a torus. The neighbour bits of a chunk that starts on the padding ring are then those of the torus
+*/
+void rgen_area(uint8_t* cells, int rows, int cols, int* start, int grid_rows, int grid_cols, double density, uint64_t seed, int torus);
+// Same as `fload_gen(...)`, but the generation is created in memory instead of being read from a file
+uint8_t* rgen_gen(int rows, int columns, double density, uint64_t seed);
+
+#endif
@@ -0,0 +1,181 @@
+#include "rule.h"
+#include "life.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+
+
+/* Compiled kernels */
+// Table of a rule, built by the preprocessor: entry `c` is `RULE_NEXT(count, birth, survival, c)`
+#define RULE_T4(count, b, s, c) RULE_NEXT(count, b, s, (c)), RULE_NEXT(count, b, s, (c) + 1), RULE_NEXT(count, b, s, (c) + 2), RULE_NEXT(count, b, s, (c) + 3)
+#define RULE_T16(count, b, s, c) RULE_T4(count, b, s, (c)), RULE_T4(count, b, s, (c) + 4), RULE_T4(count, b, s, (c) + 8), RULE_T4(count, b, s, (c) + 12)
+#define RULE_T64(count, b, s, c) RULE_T16(count, b, s, (c)), RULE_T16(count, b, s, (c) + 16), RULE_T16(count, b, s, (c) + 32), RULE_T16(count, b, s, (c) + 48)
+#define RULE_T256(count, b, s) RULE_T64(count, b, s, 0), RULE_T64(count, b, s, 64), RULE_T64(count, b, s, 128), RULE_T64(count, b, s, 192)
+
+// Constant table and a solver that only does one lookup per cell, no branches
+#define RULE_KERNEL(id, count, b, s) \
+    static const uint8_t id##_lut[256] = {RULE_T256(count, b, s)}; \
+    static void id##_solver(uint8_t* cells, int rows, int cols) { \
+        size_t len = (size_t) rows * cols; \
+        for(size_t i = 0; i < len; i++) { \
+            cells[i] = id##_lut[cells[i]]; \
+        } \
+    }
+
+RULE_KERNEL(vn_b3s23, RULE_COUNT_VON_NEUMANN, 0x008, 0x00c)
+RULE_KERNEL(life, RULE_COUNT_MOORE, 0x008, 0x00c)
+RULE_KERNEL(highlife, RULE_COUNT_MOORE, 0x048, 0x00c)
+RULE_KERNEL(seeds, RULE_COUNT_MOORE, 0x004, 0x000)
+RULE_KERNEL(daynight, RULE_COUNT_MOORE, 0x1c8, 0x1d8)
+
+static const rule_t rule_builtins[] = {
+    {"B3/S23V", RULE_VON_NEUMANN, 0x008, 0x00c, vn_b3s23_lut, vn_b3s23_solver, 1},
+    {"B3/S23", RULE_MOORE, 0x008, 0x00c, life_lut, life_solver, 1},
+    {"B36/S23", RULE_MOORE, 0x048, 0x00c, highlife_lut, highlife_solver, 1},
+    {"B2/S", RULE_MOORE, 0x004, 0x000, seeds_lut, seeds_solver, 1},
+    {"B3678/S34678", RULE_MOORE, 0x1c8, 0x1d8, daynight_lut, daynight_solver, 1},
+};
+
+static const char* rule_aliases[][2] = {
+    {"life", "B3/S23"},
+    {"highlife", "B36/S23"},
+    {"seeds", "B2/S"},
+    {"daynight", "B3678/S34678"},
+};
+
+
+/* Generic kernel */
+// Any other rule: same loop, over a table filled at runtime
+static uint8_t generic_lut[256];
+static char generic_name[32];
+static rule_t generic_rule = {generic_name, RULE_VON_NEUMANN, 0, 0, generic_lut, NULL, 0};
+
+static void generic_solver(uint8_t* cells, int rows, int cols) {
+    size_t len = (size_t) rows * cols;
+    for(size_t i = 0; i < len; i++) {
+        cells[i] = generic_lut[cells[i]];
+    }
+}
+
+
+static const rule_t* rule = &rule_builtins[0];
+
+
+// Reads the digits of a B or S set. Returns the number of characters read, -1 if a digit is over `max`
+static int rule_parse_set(const char* spec, int max, uint16_t* set) {
+    int i = 0;
+    *set = 0;
+    for(; spec[i] >= '0' && spec[i] <= '9'; i++) {
+        if(spec[i] - '0' > max) return -1;
+        *set |= 1 << (spec[i] - '0');
+    }
+    return i;
+}
+
+
+int rule_set(const char* spec) {
+    for(int i = 0; i < (int) (sizeof(rule_aliases) / sizeof(rule_aliases[0])); i++) {
+        if(strcmp(spec, rule_aliases[i][0]) == 0) {
+            spec = rule_aliases[i][1];
+        }
+    }
+
+    // `B<digits>/S<digits>`, the neighbourhood is only known at the end
+    int len = strlen(spec);
+    int neighbourhood = len > 0 && (spec[len - 1] == 'V' || spec[len - 1] == 'v') ? RULE_VON_NEUMANN : RULE_MOORE;
+    int max = neighbourhood == RULE_VON_NEUMANN ? 4 : 8;
+
+    uint16_t birth = 0, survival = 0;
+    int at = 0;
+    if(spec[at] != 'B' && spec[at] != 'b') return -1;
+    at++;
+
+    int read = rule_parse_set(spec + at, max, &birth);
+    if(read < 0) return -1;
+    at += read;
+
+    if(spec[at] != '/' || (spec[at + 1] != 'S' && spec[at + 1] != 's')) return -1;
+    at += 2;
+
+    read = rule_parse_set(spec + at, max, &survival);
+    if(read < 0) return -1;
+    at += read;
+
+    if(at != len - (neighbourhood == RULE_VON_NEUMANN)) return -1;
+
+    // The padding is solved like any other cell, with no alive neighbours it has to stay dead
+    if(birth & 1) return -1;
+
+    for(int i = 0; i < (int) (sizeof(rule_builtins) / sizeof(rule_t)); i++) {
+        if(rule_builtins[i].neighbourhood == neighbourhood && rule_builtins[i].birth == birth && rule_builtins[i].survival == survival) {
+            rule = &rule_builtins[i];
+            return 0;
+        }
+    }
+
+    // Canonical name: digits in order
+    int pos = snprintf(generic_name, sizeof(generic_name), "B");
+    for(int n = 0; n <= max; n++) {
+        if(birth & (1 << n)) pos += snprintf(generic_name + pos, sizeof(generic_name) - pos, "%d", n);
+    }
+    pos += snprintf(generic_name + pos, sizeof(generic_name) - pos, "/S");
+    for(int n = 0; n <= max; n++) {
+        if(survival & (1 << n)) pos += snprintf(generic_name + pos, sizeof(generic_name) - pos, "%d", n);
+    }
+    if(neighbourhood == RULE_VON_NEUMANN) {
+        snprintf(generic_name + pos, sizeof(generic_name) - pos, "V");
+    }
+
+    for(int c = 0; c < 256; c++) {
+        generic_lut[c] = neighbourhood == RULE_VON_NEUMANN ? RULE_NEXT(RULE_COUNT_VON_NEUMANN, birth, survival, c) : RULE_NEXT(RULE_COUNT_MOORE, birth, survival, c);
+    }
+
+    generic_rule.neighbourhood = neighbourhood;
+    generic_rule.birth = birth;
+    generic_rule.survival = survival;
+    generic_rule.solver = generic_solver;
+    rule = &generic_rule;
+
+    return 0;
+}
+
+
+const rule_t* rule_get() {
+    return rule;
+}
+
+
+void rule_solver(uint8_t* cells, int rows, int cols) {
+    rule->solver(cells, rows, cols);
+}
+
+
+void rule_updater(uint8_t* cells, int rows, int cols) {
+    rule_updater_rect(cells + cols + 1, rows - 2, cols - 2, cols);
+}
+
+
+void rule_updater_rect(uint8_t* cells, int rows, int cols, int row_len) {
+    if(rule->neighbourhood == RULE_VON_NEUMANN) {
+        for(int i = 0; i < rows; i++) {
+            for(int j = 0; j < cols; j++) {
+                size_t idx = (size_t) i * row_len + j;
+                cells[idx] = IS_ALIVE(cells[idx]) |
+                    (CELL_WEST * IS_ALIVE(cells[idx - 1])) | (CELL_NORTH * IS_ALIVE(cells[idx - row_len])) |
+                    (CELL_EAST * IS_ALIVE(cells[idx + 1])) | (CELL_SOUTH * IS_ALIVE(cells[idx + row_len]));
+            }
+        }
+    }
+    else {
+        for(int i = 0; i < rows; i++) {
+            for(int j = 0; j < cols; j++) {
+                size_t idx = (size_t) i * row_len + j;
+                int count = IS_ALIVE(cells[idx - row_len - 1]) + IS_ALIVE(cells[idx - row_len]) + IS_ALIVE(cells[idx - row_len + 1]) +
+                    IS_ALIVE(cells[idx - 1]) + IS_ALIVE(cells[idx + 1]) +
+                    IS_ALIVE(cells[idx + row_len - 1]) + IS_ALIVE(cells[idx + row_len]) + IS_ALIVE(cells[idx + row_len + 1]);
+                cells[idx] = IS_ALIVE(cells[idx]) | (count << 1);
+            }
+        }
+    }
+}
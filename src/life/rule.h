@@ -0,0 +1,48 @@
+#ifndef _RULE
+#define _RULE
+
+#include <stdint.h>
+
+/* Constants */
+#define RULE_VON_NEUMANN 0 // W, N, E, S: one bit per neighbour in the cell (`CELL_WEST`, ...)
+#define RULE_MOORE       1 // the 8 surrounding cells: their count in bits 1-4 of the cell
+
+// The rule of the original program: B3/S23 over the 4 von Neumann neighbours
+#define RULE_DEFAULT "B3/S23V"
+
+/* Macros */
+#define RULE_POP4(x) (((x) & 1) + (((x) >> 1) & 1) + (((x) >> 2) & 1) + (((x) >> 3) & 1))
+// Alive neighbours encoded in a cell
+#define RULE_COUNT_VON_NEUMANN(cell) RULE_POP4((cell) >> 1)
+#define RULE_COUNT_MOORE(cell) (((cell) >> 1) & 0xf)
+// The cell after the solver: same neighbour bits, alive bit from the birth or survival set (bit n: n alive neighbours)
+#define RULE_NEXT(count, birth, survival, cell) (((cell) & 0xfe) | ((((cell) & 1) ? (survival) : (birth)) >> count(cell) & 1))
+
+/* Types */
+// Life-like rule. The solver only looks at the cell itself, so a rule is a 256 entry table from a cell to its next value
+typedef struct _rule_t {
+    const char* name; // B/S notation, with a `V` at the end for von Neumann neighbourhoods
+    int neighbourhood;
+    uint16_t birth;
+    uint16_t survival;
+
+    const uint8_t* lut;
+    void (*solver)(uint8_t* cells, int rows, int cols);
+    int compiled; // 1 if the table and the solver were built at compile time
+} rule_t;
+
+/* Rules */
+// Parses `B<digits>/S<digits>[V]` (or the name of a built-in rule: life, highlife, seeds, daynight) and makes it the rule of this process. Returns 0 on success, -1 otherwise
+// Built-in rules get the solver compiled for their table, any other one shares a generic solver over a table filled here
+int rule_set(const char* spec);
+const rule_t* rule_get();
+
+/* Kernels */
+// Next alive bit of every cell, with the rule of the process
+void rule_solver(uint8_t* cells, int rows, int cols);
+// Recomputes the neighbour information of every cell but the outer ring of the buffer, from the alive bits. The ring is only read
+void rule_updater(uint8_t* cells, int rows, int cols);
+// Same, for the `rows * cols` cells from `cells` inside a buffer whose rows are `row_len` cells long. Their neighbours around them are only read
+void rule_updater_rect(uint8_t* cells, int rows, int cols, int row_len);
+
+#endif
@@ -0,0 +1,424 @@
+#include "sched.h"
+#include "rule.h"
+
+#include <stdlib.h>
+#include <sched.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+
+// Online processors, 1 if the platform cannot tell
+static int sched_processors() {
+    #ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors;
+    #elif defined(_SC_NPROCESSORS_ONLN)
+    return sysconf(_SC_NPROCESSORS_ONLN);
+    #else
+    return 1;
+    #endif
+}
+
+
+static void sched_gate_init(sched_gate_t* gate, int count) {
+    pthread_mutex_init(&gate->lock, NULL);
+    pthread_cond_init(&gate->opened, NULL);
+    gate->count = count;
+    gate->waiting = 0;
+    gate->round = 0;
+}
+
+
+static void sched_gate_destroy(sched_gate_t* gate) {
+    pthread_mutex_destroy(&gate->lock);
+    pthread_cond_destroy(&gate->opened);
+}
+
+
+// Returns once all the `count` threads are waiting, the same as `sched_gate_wait(...)`
+static void sched_gate_wait(sched_gate_t* gate) {
+    pthread_mutex_lock(&gate->lock);
+    long round = gate->round;
+
+    if(++gate->waiting == gate->count) {
+        gate->waiting = 0;
+        gate->round++;
+        pthread_cond_broadcast(&gate->opened);
+    }
+    else {
+        while(gate->round == round) {
+            pthread_cond_wait(&gate->opened, &gate->lock);
+        }
+    }
+    pthread_mutex_unlock(&gate->lock);
+}
+
+
+static void sched_push(sched_t* sched, int thread, int tile) {
+    sched_deque_t* deque = &sched->deques[thread];
+    pthread_mutex_lock(&deque->lock);
+    deque->tiles[deque->tail++ % sched->tile_cnt] = tile;
+    pthread_mutex_unlock(&deque->lock);
+}
+
+
+// Takes the newest task of the thread's own deque, or else the oldest one of another thread. Returns 0 if there was none
+static int sched_take(sched_t* sched, int thread, int* tile) {
+    for(int k = 0; k < sched->thread_cnt; k++) {
+        sched_deque_t* deque = &sched->deques[(thread + k) % sched->thread_cnt];
+        int found = 0;
+
+        pthread_mutex_lock(&deque->lock);
+        if(deque->tail > deque->head) {
+            *tile = k == 0 ? deque->tiles[--deque->tail % sched->tile_cnt] : deque->tiles[deque->head++ % sched->tile_cnt];
+            found = 1;
+        }
+        pthread_mutex_unlock(&deque->lock);
+
+        if(found) return 1;
+    }
+    return 0;
+}
+
+
+// Copies the edges of a solved tile into the opposite side of the ring, as `wrap_ring(...)` does for the whole universe
+static void sched_wrap(sched_t* sched, area_t* area) {
+    uint8_t* cells = sched->cells;
+    size_t cols = sched->cols;
+    int last_row = sched->rows - 2, last_col = sched->cols - 2;
+
+    for(int j = area->from[0]; j <= area->to[0]; j++) {
+        if(area->from[1] == 1) cells[(last_row + 1) * cols + j] = cells[cols + j];
+        if(area->to[1] == last_row) cells[j] = cells[last_row * cols + j];
+    }
+    for(int i = area->from[1]; i <= area->to[1]; i++) {
+        if(area->from[0] == 1) cells[i * cols + last_col + 1] = cells[i * cols + 1];
+        if(area->to[0] == last_col) cells[i * cols] = cells[i * cols + last_col];
+    }
+
+    // Corners go to the opposite corner
+    if(area->from[1] == 1 && area->from[0] == 1) cells[(last_row + 1) * cols + last_col + 1] = cells[cols + 1];
+    if(area->from[1] == 1 && area->to[0] == last_col) cells[(last_row + 1) * cols] = cells[cols + last_col];
+    if(area->to[1] == last_row && area->from[0] == 1) cells[last_col + 1] = cells[last_row * cols + 1];
+    if(area->to[1] == last_row && area->to[0] == last_col) cells[0] = cells[last_row * cols + last_col];
+}
+
+
+// One phase of one tile, then the tiles around it whose next phase this completes go to the thread's deque
+static void sched_task(sched_t* sched, int thread, int tile) {
+    area_t* area = &sched->tiles[tile];
+    int p = sched->phase[tile];
+    int width = area->to[0] - area->from[0] + 1;
+    int height = area->to[1] - area->from[1] + 1;
+    uint8_t* first = sched->cells + (size_t) area->from[1] * sched->cols + area->from[0];
+
+    if(p % 2 == 0) {
+        uint64_t delta = 0;
+        size_t at = (size_t) thread * sched->delta_cap + p / 2;
+        for(int i = 0; i < height; i++) {
+            uint8_t* row = first + (size_t) i * sched->cols;
+            int start[] = {area->from[0], area->from[1] + i};
+            if(sched->with_stats) {
+                delta ^= ssolver(row, 1, width, start, &sched->stats[at], NULL);
+            }
+            else if(sched->hash) {
+                delta ^= hsolver(row, 1, width, start);
+            }
+            else {
+                solver(row, 1, width);
+            }
+            if(sched->map && p / 2 + 1 == sched->map_gen) {
+                dmap_row(&sched->parts[tile], row, start[1], start[0], width);
+            }
+        }
+        sched->deltas[at] ^= delta;
+
+        if(sched->torus) {
+            sched_wrap(sched, area);
+        }
+    }
+    else {
+        rule_updater_rect(first, height, width, sched->cols);
+    }
+
+    if(p + 1 < sched->phases) {
+        for(int k = 0; k < sched->nbr_cnt[tile]; k++) {
+            int nbr = sched->nbrs[tile * 9 + k];
+            atomic_int* ready = &sched->ready[nbr][(p + 1) % 2];
+
+            // The last tile around `nbr` to finish makes it ready. Nobody else counts for this parity before it has run
+            if(atomic_fetch_add(ready, 1) + 1 == sched->nbr_cnt[nbr]) {
+                atomic_store(ready, 0);
+                sched->phase[nbr] = p + 1;
+                sched_push(sched, thread, nbr);
+            }
+        }
+    }
+
+    atomic_fetch_add(&sched->completed, 1);
+}
+
+
+static void sched_work(sched_t* sched, int thread) {
+    long total = (long) sched->tile_cnt * sched->phases;
+    int tile;
+
+    while(atomic_load(&sched->completed) < total) {
+        if(sched_take(sched, thread, &tile)) {
+            sched_task(sched, thread, tile);
+        }
+        else {
+            sched_yield();
+        }
+    }
+}
+
+
+typedef struct _sched_arg_t {
+    sched_t* sched;
+    int thread;
+} sched_arg_t;
+
+
+static void* sched_helper(void* arg) {
+    sched_t* sched = ((sched_arg_t*) arg)->sched;
+    int thread = ((sched_arg_t*) arg)->thread;
+    free(arg);
+
+    for(;;) {
+        sched_gate_wait(&sched->start);
+        if(sched->quit) break;
+
+        sched_work(sched, thread);
+        sched_gate_wait(&sched->end);
+    }
+    return NULL;
+}
+
+
+sched_t* sched_create(int rows, int cols, int torus, int tile, int threads) {
+    // Zeroed, so a pool that could not be built can be taken apart by `sched_free(...)` from any point
+    sched_t* sched = calloc(1, sizeof(sched_t));
+    if(!sched) return NULL;
+
+    sched->rows = rows;
+    sched->cols = cols;
+    sched->torus = torus;
+
+    int tiles_y = (rows - 2 + tile - 1) / tile;
+    int tiles_x = (cols - 2 + tile - 1) / tile;
+    sched->tile_cnt = tiles_x * tiles_y;
+
+    // The tiles around each tile, wrapped on a torus. Grids only 1 or 2 tiles across would list some twice
+    sched->tiles = malloc(sched->tile_cnt * sizeof(area_t));
+    sched->nbrs = malloc((size_t) sched->tile_cnt * 9 * sizeof(int));
+    sched->nbr_cnt = malloc(sched->tile_cnt * sizeof(int));
+    sched->ready = malloc(sched->tile_cnt * sizeof(*sched->ready));
+    sched->phase = malloc(sched->tile_cnt * sizeof(int));
+    sched->parts = malloc(sched->tile_cnt * sizeof(dmap_t));
+    if(!sched->tiles || !sched->nbrs || !sched->nbr_cnt || !sched->ready || !sched->phase || !sched->parts) {
+        sched_free(sched);
+        return NULL;
+    }
+    fill_jobs_grid(sched->tiles, rows - 2, cols - 2, tiles_x, tiles_y);
+    for(int t = 0; t < sched->tile_cnt; t++) {
+        int ty = t / tiles_x, tx = t % tiles_x;
+        sched->nbr_cnt[t] = 0;
+
+        for(int dy = -1; dy <= 1; dy++) {
+            for(int dx = -1; dx <= 1; dx++) {
+                int y = ty + dy, x = tx + dx;
+                if(torus) {
+                    y = (y + tiles_y) % tiles_y;
+                    x = (x + tiles_x) % tiles_x;
+                }
+                else if(y < 0 || y >= tiles_y || x < 0 || x >= tiles_x) {
+                    continue;
+                }
+
+                int nbr = y * tiles_x + x, seen = 0;
+                for(int k = 0; k < sched->nbr_cnt[t]; k++) {
+                    seen |= sched->nbrs[t * 9 + k] == nbr;
+                }
+                if(!seen) {
+                    sched->nbrs[t * 9 + sched->nbr_cnt[t]++] = nbr;
+                }
+            }
+        }
+    }
+
+    if(threads <= 0) {
+        threads = MAX(1, sched_processors());
+    }
+    sched->deques = calloc(threads, sizeof(sched_deque_t));
+    sched->threads = malloc(threads * sizeof(pthread_t));
+    if(!sched->deques || !sched->threads) {
+        sched_free(sched);
+        return NULL;
+    }
+    sched->thread_cnt = threads;
+    for(int i = 0; i < threads; i++) {
+        pthread_mutex_init(&sched->deques[i].lock, NULL);
+    }
+    for(int i = 0; i < threads; i++) {
+        sched->deques[i].tiles = malloc(sched->tile_cnt * sizeof(int));
+        if(!sched->deques[i].tiles) {
+            sched_free(sched);
+            return NULL;
+        }
+    }
+
+    sched_gate_init(&sched->start, threads);
+    sched_gate_init(&sched->end, threads);
+    sched->running = 1;
+    for(int i = 1; i < threads; i++) {
+        sched_arg_t* arg = malloc(sizeof(sched_arg_t));
+        if(!arg) {
+            sched_free(sched);
+            return NULL;
+        }
+        arg->sched = sched;
+        arg->thread = i;
+
+        if(pthread_create(&sched->threads[i], NULL, sched_helper, arg) != 0) {
+            free(arg);
+            sched_free(sched);
+            return NULL;
+        }
+        sched->running++;
+    }
+
+    return sched;
+}
+
+
+void sched_free(sched_t* sched) {
+    if(!sched) return;
+
+    if(sched->running > 0) {
+        // Helpers only leave through the start gate. A pool that could not start all its threads opens it with the ones it has
+        pthread_mutex_lock(&sched->start.lock);
+        sched->start.count = sched->running;
+        pthread_mutex_unlock(&sched->start.lock);
+
+        sched->quit = 1;
+        sched_gate_wait(&sched->start);
+        for(int i = 1; i < sched->running; i++) {
+            pthread_join(sched->threads[i], NULL);
+        }
+        sched_gate_destroy(&sched->start);
+        sched_gate_destroy(&sched->end);
+    }
+
+    for(int i = 0; i < sched->thread_cnt; i++) {
+        pthread_mutex_destroy(&sched->deques[i].lock);
+        free(sched->deques[i].tiles);
+    }
+    free(sched->deques);
+    free(sched->threads);
+    free(sched->tiles);
+    free(sched->nbrs);
+    free(sched->nbr_cnt);
+    free(sched->ready);
+    free(sched->phase);
+    free(sched->parts);
+    free(sched->part_counts);
+    free(sched->deltas);
+    free(sched->stats);
+    free(sched);
+}
+
+
+int sched_gens(sched_t* sched, uint8_t* cells, int gens, uint64_t* deltas, gen_stats_t* stats, dmap_t* map, int map_gen) {
+    if(gens <= 0) return 0;
+
+    if(gens > sched->delta_cap) {
+        free(sched->deltas);
+        free(sched->stats);
+        sched->deltas = malloc((size_t) sched->thread_cnt * gens * sizeof(uint64_t));
+        sched->stats = malloc((size_t) sched->thread_cnt * gens * sizeof(gen_stats_t));
+        sched->delta_cap = gens;
+        if(!sched->deltas || !sched->stats) {
+            free(sched->deltas);
+            free(sched->stats);
+            sched->deltas = NULL;
+            sched->stats = NULL;
+            sched->delta_cap = 0;
+            return -1;
+        }
+    }
+    for(size_t i = 0; i < (size_t) sched->thread_cnt * sched->delta_cap; i++) {
+        sched->deltas[i] = 0;
+        stats_clear(&sched->stats[i]);
+    }
+
+    sched->cells = cells;
+    sched->phases = 2 * gens;
+    sched->hash = deltas != NULL;
+    sched->with_stats = stats != NULL;
+    sched->map = map;
+    sched->map_gen = map_gen;
+    if(map) {
+        // Each tile counts into a part of its own, over the blocks of the map it crosses, so no two threads count into the same place
+        size_t total = 0;
+        for(int t = 0; t < sched->tile_cnt; t++) {
+            total += DMAP_PART_BLOCKS(sched->tiles[t].from, sched->tiles[t].to, map->side);
+        }
+        if(total > sched->part_cap) {
+            free(sched->part_counts);
+            sched->part_counts = malloc(total * sizeof(uint32_t));
+            sched->part_cap = sched->part_counts ? total : 0;
+            if(!sched->part_counts) return -1;
+        }
+
+        total = 0;
+        for(int t = 0; t < sched->tile_cnt; t++) {
+            dmap_init_part(&sched->parts[t], map->rows, map->cols, map->side, sched->tiles[t].from, sched->tiles[t].to, sched->part_counts + total);
+            dmap_clear(&sched->parts[t]);
+            total += DMAP_PART_BLOCKS(sched->tiles[t].from, sched->tiles[t].to, map->side);
+        }
+    }
+    atomic_store(&sched->completed, 0);
+
+    // Every tile starts with its solver, the threads get neighbouring tiles
+    for(int t = 0; t < sched->tile_cnt; t++) {
+        atomic_store(&sched->ready[t][0], 0);
+        atomic_store(&sched->ready[t][1], 0);
+        sched->phase[t] = 0;
+    }
+    for(int i = 0; i < sched->thread_cnt; i++) {
+        int first = (long) sched->tile_cnt * i / sched->thread_cnt;
+        int last = (long) sched->tile_cnt * (i + 1) / sched->thread_cnt;
+        for(int t = first; t < last; t++) {
+            sched->deques[i].tiles[t - first] = t;
+        }
+        sched->deques[i].head = 0;
+        sched->deques[i].tail = last - first;
+    }
+
+    sched_gate_wait(&sched->start);
+    sched_work(sched, 0);
+    sched_gate_wait(&sched->end);
+
+    if(sched->torus) {
+        clear_ring(cells, sched->rows, sched->cols);
+    }
+
+    for(int g = 0; g < gens; g++) {
+        if(deltas) deltas[g] = 0;
+        for(int i = 0; i < sched->thread_cnt; i++) {
+            if(deltas) deltas[g] ^= sched->deltas[(size_t) i * sched->delta_cap + g];
+            if(stats) stats_merge(&stats[g], &sched->stats[(size_t) i * sched->delta_cap + g]);
+        }
+    }
+    for(int t = 0; map && t < sched->tile_cnt; t++) {
+        dmap_add(map, &sched->parts[t]);
+    }
+
+    return 0;
+}
@@ -0,0 +1,82 @@
+#ifndef _SCHED
+#define _SCHED
+
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+#include "life.h"
+
+/* Constants */
+// Side of the tiles of the threaded version, when `--tile` is not given
+#define SCHED_DEFAULT_TILE 128
+
+/* Types */
+// Where all the threads of the pool meet, out of a mutex and a condition alone: `pthread_barrier_t` is optional in POSIX and missing from some platforms (macOS)
+typedef struct _sched_gate_t {
+    pthread_mutex_t lock;
+    pthread_cond_t opened;
+    int count; // threads that meet
+    int waiting;
+    long round; // times it opened, so a thread woken late does not wait for the next round
+} sched_gate_t;
+
+// Tasks of one thread. The owner pushes and pops at the tail, the others steal from the head
+typedef struct _sched_deque_t {
+    pthread_mutex_t lock;
+    int* tiles; // ring of `tile_cnt` entries: a tile is in at most one deque at a time
+    long head, tail; // `tail - head` tasks
+} sched_deque_t;
+
+// Pool of threads advancing one universe in place, tile by tile. Each tile is solved (even phases) and updated (odd phases) in turn
+typedef struct _sched_t {
+    int rows, cols; // padded universe
+    int torus;
+
+    area_t* tiles;
+    int tile_cnt;
+    int* nbrs; // up to 9 tiles around each tile, itself included, each once (`tile_cnt * 9`)
+    int* nbr_cnt;
+    atomic_int (*ready)[2]; // tiles around a tile done with the phase before its next one, per phase parity
+    int* phase; // next phase of each tile, written before it is pushed
+
+    int thread_cnt;
+    pthread_t* threads; // `thread_cnt - 1` helpers, the caller is thread 0
+    int running; // threads started, the caller included
+    sched_gate_t start, end;
+    sched_deque_t* deques;
+    int quit;
+
+    // Current call of `sched_gens(...)`
+    uint8_t* cells;
+    int phases;
+    atomic_long completed;
+    uint64_t* deltas; // `thread_cnt * delta_cap`, per thread and generation
+    gen_stats_t* stats; // same, if the call wants statistics
+    int delta_cap;
+    int hash;
+    int with_stats;
+    dmap_t* map; // counted by the solver of generation `map_gen` (from 1), as it goes, into the part of each tile
+    int map_gen;
+    dmap_t* parts; // `tile_cnt`, over the blocks of the map each tile crosses, added to `map` once the call is done
+    uint32_t* part_counts;
+    size_t part_cap;
+} sched_t;
+
+/* Threaded generations */
+// Pool of `threads` threads (the caller included, one per online processor if 0) over a padded universe of `rows * cols` cells, cut in `tile * tile` tiles. Returns NULL if the pool cannot be allocated or its threads started
+// NOTE: Do NOT forget to free the returned pointer with `sched_free(...)`, which also joins the threads
+sched_t* sched_create(int rows, int cols, int torus, int tile, int threads);
+void sched_free(sched_t* sched);
+// Advances `cells` `gens` generations on the pool, to the same cells as `next_gen(...)` would. `deltas[g]` gets the hash delta of generation `g`, its statistics are added to `stats[g]` (see `ssolver(...)`) and the alive cells after generation `map_gen` (from 1) to `map`, unless NULL
+// Returns 0, or -1 (leaving `cells` as they were) if there is no memory for the per thread deltas of `gens` generations or the parts of the map
+/*
+    **NOTE:**:
+        - There is no barrier between generations: a tile starts a phase as soon as the tiles around it are done with the phase before (dependency counters), so neighbouring tiles are never more than one phase apart and read each other's cells in place, without halo copies
+        - The tiles a task makes ready go to the deque of its thread, and idle threads steal from the others, so clustered activity spreads over the pool
+        - Neighbours in the same update phase read each other's edge cells while rewriting their own, but an update only changes the neighbour bits of a cell, never the alive bit the others read
+        - On a torus, the edge tiles copy their edges into the opposite side of the dead ring after solving, and the ring is cleared once the call is done
+*/
+int sched_gens(sched_t* sched, uint8_t* cells, int gens, uint64_t* deltas, gen_stats_t* stats, dmap_t* map, int map_gen);
+
+#endif
@@ -0,0 +1,135 @@
+#include "stream.h"
+
+#include <stdint.h>
+
+
+// `rows` rows of `cols` cells, in a buffer whose rows are `row_len` cells long
+// NOTE: Do NOT forget to free the returned type with `MPI_Type_free(...)`
+static MPI_Datatype stream_rect(int rows, int cols, int row_len) {
+    MPI_Datatype rect;
+    MPI_Type_vector(rows, cols, row_len, MPI_UINT8_T, &rect);
+    MPI_Type_commit(&rect);
+    return rect;
+}
+
+
+// Posts the sends (or receives) of the parts of the band that starts at row `first` (padded universe) to (from) the workers whose blocks it crosses. Returns the requests posted
+static int stream_post(uint8_t* band, int first, int rows, int columns, area_t* jobs, int job_cnt, int send, MPI_Comm comm, MPI_Request* requests) {
+    int row_len = columns + 2;
+    int posted = 0;
+    for(int i = 0; i < job_cnt; i++) {
+        int from = MAX(first, jobs[i].from[1]);
+        int to = MIN(first + rows - 1, jobs[i].to[1]);
+        if(from > to) continue;
+
+        uint8_t* part = band + (size_t) (from - first) * row_len + jobs[i].from[0];
+        MPI_Datatype rect = stream_rect(to - from + 1, jobs[i].to[0] - jobs[i].from[0] + 1, row_len);
+        if(send) {
+            MPI_Isend(part, 1, rect, i + 1, DATA_TAG, comm, &requests[posted++]);
+        }
+        else {
+            MPI_Irecv(part, 1, rect, i + 1, DATA_TAG, comm, &requests[posted++]);
+        }
+        MPI_Type_free(&rect);
+    }
+    return posted;
+}
+
+
+void stream_scatter(FILE* in_file, int rows, int columns, area_t* jobs, int job_cnt, int band_rows, uint8_t* staging, uint64_t* hash, MPI_Comm comm) {
+    uint8_t* bands[] = {staging, staging + (size_t) band_rows * (columns + 2)};
+    MPI_Request requests[2][job_cnt];
+    int pending[] = {0, 0};
+
+    if(hash) *hash = 0;
+
+    for(int b = 0, first = 1; first <= rows; b++, first += band_rows) {
+        int n = MIN(band_rows, rows - first + 1);
+        uint8_t* band = bands[b % 2];
+
+        // The band before the last one has to be out before its buffer is parsed into again
+        MPI_Waitall(pending[b % 2], requests[b % 2], MPI_STATUSES_IGNORE);
+
+        fread_rows(in_file, band + 1, n, columns, columns + 2);
+        if(hash) {
+            int start[] = {0, first};
+            *hash ^= ghash(band, n, columns + 2, start);
+        }
+
+        pending[b % 2] = stream_post(band, first, n, columns, jobs, job_cnt, 1, comm, requests[b % 2]);
+    }
+
+    MPI_Waitall(pending[0], requests[0], MPI_STATUSES_IGNORE);
+    MPI_Waitall(pending[1], requests[1], MPI_STATUSES_IGNORE);
+}
+
+
+// Writes a row of the dead padding ring, `cols` cells long
+static void stream_dead_row(FILE* out_file, int cols) {
+    for(int j = 0; j < cols; j++) {
+        fputc('.', out_file);
+    }
+    fputc('\n', out_file);
+}
+
+
+void stream_gather(FILE* out_file, int rows, int columns, area_t* jobs, int job_cnt, int band_rows, uint8_t* staging, MPI_Comm comm) {
+    uint8_t* bands[] = {staging, staging + (size_t) band_rows * (columns + 2)};
+    MPI_Request requests[2][job_cnt];
+    int pending[] = {0, 0};
+
+    pending[0] = stream_post(bands[0], 1, MIN(band_rows, rows), columns, jobs, job_cnt, 0, comm, requests[0]);
+
+    for(int b = 0, first = 1; first <= rows; b++, first += band_rows) {
+        int n = MIN(band_rows, rows - first + 1);
+
+        // The next band comes in while this one is written
+        int next = first + band_rows;
+        if(next <= rows) {
+            pending[(b + 1) % 2] = stream_post(bands[(b + 1) % 2], next, MIN(band_rows, rows - next + 1), columns, jobs, job_cnt, 0, comm, requests[(b + 1) % 2]);
+        }
+
+        MPI_Waitall(pending[b % 2], requests[b % 2], MPI_STATUSES_IGNORE);
+        pending[b % 2] = 0;
+
+        if(b == 0) {
+            stream_dead_row(out_file, columns + 2);
+        }
+        fwrite_rows(out_file, bands[b % 2], n, columns + 2, columns + 2);
+    }
+    stream_dead_row(out_file, columns + 2);
+}
+
+
+// Receives (or sends) the rows of the block, one message per band it crosses
+static void stream_block(block_t* block, int band_rows, int send, MPI_Comm comm) {
+    int first_row = block->origin[1];
+    int last_row = first_row + block->rows - 1;
+    MPI_Datatype rect;
+
+    // Bands start at row 1 of the padded universe
+    for(int first = 1 + (first_row - 1) / band_rows * band_rows; first <= last_row; first += band_rows) {
+        int from = MAX(first, first_row);
+        int to = MIN(first + band_rows - 1, last_row);
+
+        uint8_t* part = BLOCK_FIRST(block) + (size_t) (from - first_row) * block->cols_real;
+        rect = stream_rect(to - from + 1, block->cols, block->cols_real);
+        if(send) {
+            MPI_Send(part, 1, rect, 0, DATA_TAG, comm);
+        }
+        else {
+            MPI_Recv(part, 1, rect, 0, DATA_TAG, comm, MPI_STATUS_IGNORE);
+        }
+        MPI_Type_free(&rect);
+    }
+}
+
+
+void stream_recv(block_t* block, int band_rows, MPI_Comm comm) {
+    stream_block(block, band_rows, 0, comm);
+}
+
+
+void stream_send(block_t* block, int band_rows, MPI_Comm comm) {
+    stream_block(block, band_rows, 1, comm);
+}
@@ -0,0 +1,43 @@
+#ifndef _STREAM
+#define _STREAM
+
+#include <stdio.h>
+#include <stdint.h>
+#include <mpi.h>
+
+#include "life.h"
+#include "block.h"
+
+/* Constants */
+// Staging space of one band. The master keeps two of them, whatever the size of the universe
+#define STREAM_BAND_SIZE (4 << 20)
+
+/* Macros */
+// Rows of the bands of a universe `columns` cells wide (without padding)
+#define STREAM_BAND_ROWS(columns) MAX(1, STREAM_BAND_SIZE / ((columns) + 2))
+
+/* Streaming */
+// Master: parses the rows of `in_file` band by band and sends each band to the workers whose blocks it crosses (job `i` on rank `i + 1`), while the next one is parsed
+/*
+    Args:
+        FILE*: generation file, right after its dimensions (see `fopen_gen(...)`)
+        int: rows of the universe (without padding)
+        int: columns of the universe (without padding)
+        area_t*: blocks of the workers, in the padded universe
+        int: number of blocks
+        int: rows of a band (`STREAM_BAND_ROWS(...)`)
+        uint8_t*: staging space, 2 bands of `band_rows * (columns + 2)` cells. Bands keep the padding columns, which have to be dead
+        uint64_t*: where the hash of the universe goes (see `ghash(...)`). NULL skips it
+        MPI_Comm: master and workers
+    **NOTE:**:
+        - Bands only carry the alive bits: the workers rebuild the neighbour data with `block_refresh(...)`
+        - A band's buffer is only reused once all its sends are done, so the master never holds more than the 2 bands
+*/
+void stream_scatter(FILE* in_file, int rows, int columns, area_t* jobs, int job_cnt, int band_rows, uint8_t* staging, uint64_t* hash, MPI_Comm comm);
+// Master: receives the universe from the workers band by band and writes it to `out_file` with its padding ring, as `fwrite_gen(...)` does, the next band arriving while one is written. Same arguments as `stream_scatter(...)`
+void stream_gather(FILE* out_file, int rows, int columns, area_t* jobs, int job_cnt, int band_rows, uint8_t* staging, MPI_Comm comm);
+// Worker: receives / sends the rows of its block, in the bands of the master
+void stream_recv(block_t* block, int band_rows, MPI_Comm comm);
+void stream_send(block_t* block, int band_rows, MPI_Comm comm);
+
+#endif
@@ -0,0 +1,84 @@
+#include "tile.h"
+#include "life.h"
+
+#include <string.h>
+#include <stdint.h>
+
+
+// Solver over the whole local copy that only hashes the flips of the tile (`rows * cols` cells at `at`, int[2] x, y), and adds its statistics to `stats` unless NULL
+/*
+    **NOTE:**:
+        - The solver only looks at one cell at a time, so the rows around the tile and the parts of its rows left and right of it go through the plain solver
+*/
+static uint64_t tile_hsolver(uint8_t* cells, int lrows, int lcols, int* at, int rows, int cols, int* start, gen_stats_t* stats) {
+    uint64_t delta = 0;
+    solver(cells, at[1], lcols);
+    for(int i = at[1]; i < at[1] + rows; i++) {
+        uint8_t* row = cells + (size_t) i * lcols;
+        int row_start[] = {start[0] + at[0], start[1] + i};
+
+        solver(row, 1, at[0]);
+        if(stats) {
+            delta ^= ssolver(row + at[0], 1, cols, row_start, stats, NULL);
+        }
+        else {
+            delta ^= hsolver(row + at[0], 1, cols, row_start);
+        }
+        solver(row + at[0] + cols, 1, lcols - at[0] - cols);
+    }
+    solver(cells + (size_t) (at[1] + rows) * lcols, lrows - at[1] - rows, lcols);
+    return delta;
+}
+
+
+void tile_gens(uint8_t* src, int rows, int cols, const int* ring, uint8_t* dst, int gens, int tile, uint8_t* local, int* start, uint64_t* deltas, gen_stats_t* stats, dmap_t* map, int map_gen) {
+    int none[] = {0, 0, 0, 0};
+    if(!ring) {
+        ring = none;
+    }
+
+    if(deltas) {
+        memset(deltas, 0, gens * sizeof(uint64_t));
+    }
+
+    for(int ty = ring[0]; ty < rows - ring[1]; ty += tile) {
+        int th = MIN(tile, rows - ring[1] - ty);
+
+        for(int tx = ring[2]; tx < cols - ring[3]; tx += tile) {
+            int tw = MIN(tile, cols - ring[3] - tx);
+
+            // Local copy: the tile and `gens` cells around it, clipped to the buffer
+            int ly = MAX(0, ty - gens), lx = MAX(0, tx - gens);
+            int lrows = MIN(rows, ty + th + gens) - ly;
+            int lcols = MIN(cols, tx + tw + gens) - lx;
+
+            for(int i = 0; i < lrows; i++) {
+                memcpy(local + (size_t) i * lcols, src + (size_t) (ly + i) * cols + lx, lcols * sizeof(uint8_t));
+            }
+
+            int at[] = {tx - lx, ty - ly};
+            int local_start[] = {start[0] + lx, start[1] + ly};
+            for(int gen = 0; gen < gens; gen++) {
+                if(deltas || stats) {
+                    uint64_t delta = tile_hsolver(local, lrows, lcols, at, th, tw, local_start, stats ? &stats[gen] : NULL);
+                    if(deltas) deltas[gen] ^= delta;
+                }
+                else {
+                    solver(local, lrows, lcols);
+                }
+                updater(local, lrows, lcols);
+
+                // The tile is exact after every generation, and still in cache
+                if(map && gen + 1 == map_gen) {
+                    for(int i = 0; i < th; i++) {
+                        dmap_row(map, local + (size_t) (at[1] + i) * lcols + at[0], start[1] + ty + i, start[0] + tx, tw);
+                    }
+                }
+            }
+
+            for(int i = 0; i < th; i++) {
+                memcpy(dst + (size_t) (ty + i) * cols + tx, local + (size_t) (at[1] + i) * lcols + at[0], tw * sizeof(uint8_t));
+            }
+        }
+    }
+}
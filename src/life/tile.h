@@ -0,0 +1,39 @@
+#ifndef _TILE
+#define _TILE
+
+#include <stdint.h>
+
+#include "life.h"
+
+/* Constants */
+// Generations a tile is advanced while it is in cache, when not given (`--time-block`)
+#define TILE_DEFAULT_DEPTH 8
+
+/* Macros */
+// Cells of the local copy of a tile, with its ghost border for `gens` generations
+#define TILE_LOCAL(tile, gens) (((tile) + 2 * (gens)) * ((tile) + 2 * (gens)))
+
+/* Temporal blocking */
+// Advances a buffer `gens` generations, one cache sized tile at a time
+/*
+    Args:
+        uint8_t*: buffer to advance, `rows * cols` cells. Not modified
+        int: rows of the buffer
+        int: columns of the buffer
+        int*: int[4] width of the border of the buffer that only holds ghost cells (halos) up, down, left and right. It is neither advanced nor written. NULL for none
+        uint8_t*: where the inside of the buffer (without the ghost border) ends up after `gens` generations, a buffer of the same shape. Its ghost border is left as it is
+        int: generations to advance
+        int: side of the tiles
+        uint8_t*: scratch space of `TILE_LOCAL(tile, gens)` cells
+        int*: int[2] position of the buffer's (0, 0) cell inside the padded universe (x, y)
+        uint64_t*: hash delta of each of the `gens` generations, only for the written cells. Can be NULL
+        gen_stats_t*: statistics of the written cells added to each of the `gens` generations (see `ssolver(...)`). Can be NULL
+        dmap_t*: map the alive written cells are added to, tile by tile. Can be NULL
+        int: generation of the call after which they are counted into the map, from 1
+    **NOTE:**:
+        - Each tile is copied with `gens` cells of its neighbours around it and advanced `gens` generations in the scratch space. Wrong values only come in from the edges of the copy, one cell per generation, so the tile itself stays exact (overlapped trapezoid tiling: the valid area shrinks by one cell per generation)
+        - Beyond the buffer everything is dead, same as for `next_gen(...)`, so a ghost border is only needed on the sides where the buffer is a part of a bigger universe, and then `gens` is at most its width
+*/
+void tile_gens(uint8_t* src, int rows, int cols, const int* ring, uint8_t* dst, int gens, int tile, uint8_t* local, int* start, uint64_t* deltas, gen_stats_t* stats, dmap_t* map, int map_gen);
+
+#endif
@@ -0,0 +1,95 @@
+#include "tune.h"
+#include "life.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+
+
+double tune_cost(int rows, int columns, int workers_x, int workers_y, int torus) {
+    // The last block of each row and column takes what is left, so it is the largest one
+    double block_rows = rows - (workers_y - 1) * (rows / workers_y);
+    double block_cols = columns - (workers_x - 1) * (columns / workers_x);
+
+    double cost = TUNE_CELL * block_rows * block_cols;
+    // Up and down: messages unless the universe ends there. A single column of blocks on a torus wraps its side halos in place
+    if(workers_y > 1 || torus) {
+        cost += 2 * (TUNE_MESSAGE + TUNE_ROW * block_cols);
+    }
+    if(workers_x > 1) {
+        cost += 2 * (TUNE_MESSAGE + TUNE_COL * (block_rows + 2));
+    }
+
+    return cost;
+}
+
+
+// Whether `a` goes before `b`
+static int tune_better(tune_shape_t* a, tune_shape_t* b) {
+    if(a->cost != b->cost) return a->cost < b->cost;
+
+    int blocks_a = a->workers_x * a->workers_y, blocks_b = b->workers_x * b->workers_y;
+    if(blocks_a != blocks_b) return blocks_a < blocks_b;
+
+    return a->workers_x < b->workers_x;
+}
+
+
+int tune_shapes(int rows, int columns, int workers, int torus, tune_shape_t* shapes, int max) {
+    int count = 0;
+
+    for(int wx = 1; wx <= MIN(workers, columns); wx++) {
+        for(int wy = 1; wy <= MIN(workers / wx, rows); wy++) {
+            tune_shape_t shape = {wx, wy, tune_cost(rows, columns, wx, wy, torus)};
+
+            // Insertion into the sorted list, dropping whatever falls off its end
+            int at = count;
+            while(at > 0 && tune_better(&shape, &shapes[at - 1])) at--;
+            if(at >= max) continue;
+
+            for(int i = MIN(count, max - 1); i > at; i--) {
+                shapes[i] = shapes[i - 1];
+            }
+            shapes[at] = shape;
+            count = MIN(count + 1, max);
+        }
+    }
+
+    return count;
+}
+
+
+int fload_tuning(char* tuning_file_name, int rows, int columns, int ranks, int* workers_x, int* workers_y) {
+    FILE* tuning_file = fopen(tuning_file_name, "r");
+    if(!tuning_file) {
+        return 0;
+    }
+
+    int line_rows = -1, line_cols = -1, line_ranks = -1, line_x = -1, line_y = -1;
+    int found = 0;
+
+    while(fscanf(tuning_file, "%dx%d %d %d %d", &line_rows, &line_cols, &line_ranks, &line_x, &line_y) == 5) {
+        if(line_rows == rows && line_cols == columns && line_ranks == ranks && line_x > 0 && line_y > 0) {
+            *workers_x = line_x;
+            *workers_y = line_y;
+            found = 1;
+        }
+    }
+
+    fclose(tuning_file);
+
+    return found;
+}
+
+
+void fwrite_tuning(char* tuning_file_name, int rows, int columns, int ranks, int workers_x, int workers_y) {
+    FILE* tuning_file = fopen(tuning_file_name, "a");
+    if(!tuning_file) {
+        perror("Error opening tuning file");
+        exit(errno);
+    }
+
+    fprintf(tuning_file, "%dx%d %d %d %d\n", rows, columns, ranks, workers_x, workers_y);
+
+    fclose(tuning_file);
+}
@@ -0,0 +1,37 @@
+#ifndef _TUNE
+#define _TUNE
+
+/* Constants */
+// Cost model of a generation, in units of the time it takes to solve and update one cell
+#define TUNE_CELL    1.0    // a cell of the block
+#define TUNE_MESSAGE 2000.0 // latency of a halo message
+#define TUNE_ROW     0.25   // a cell of a row halo, contiguous
+#define TUNE_COL     2.0    // a cell of a column halo: strided, one cache line per cell, packed before it is sent
+
+// Cheapest shapes of the model that the calibration times (`--tune-gens`)
+#define TUNE_CANDIDATES 3
+#define TUNE_DEFAULT_FILE "tuning.txt"
+
+/* Types */
+typedef struct _tune_shape_t {
+    int workers_x, workers_y; // blocks across and down, one worker each
+    double cost; // modeled cost of a generation
+} tune_shape_t;
+
+/* Model */
+// Modeled cost of a generation of the largest block, when a `rows` x `columns` universe is split in `workers_x` x `workers_y` blocks (see `create_jobs_grid(...)`)
+double tune_cost(int rows, int columns, int workers_x, int workers_y, int torus);
+// Fills `shapes` with the (up to) `max` cheapest shapes of at most `workers` blocks, cheapest first. Returns how many there are
+/*
+    **NOTE:**:
+        - Workers that would not make a generation cheaper are left idle
+        - On equal costs, the shape with fewer blocks wins, then the one with fewer columns of blocks (cheaper halos)
+*/
+int tune_shapes(int rows, int columns, int workers, int torus, tune_shape_t* shapes, int max);
+
+/* Tuning file */
+// One `<rows>x<columns> <ranks> <workers_x> <workers_y>` entry per line. Returns 1 if the universe and rank count have an entry (later entries override older ones), 0 otherwise
+int fload_tuning(char* tuning_file_name, int rows, int columns, int ranks, int* workers_x, int* workers_y);
+void fwrite_tuning(char* tuning_file_name, int rows, int columns, int ranks, int workers_x, int workers_y);
+
+#endif
@@ -0,0 +1,166 @@
+#include "wire.h"
+#include "life.h"
+
+#include <string.h>
+#include <stdint.h>
+
+
+// Low bit of each byte of a word
+#define WIRE_LOW_BITS 0x0101010101010101ull
+// Moves the low bit of byte `k` to bit `56 + k`. The partial products never overlap, so nothing carries
+#define WIRE_GATHER   0x0102040810204080ull
+
+// Word of 8 cells (0 or 1) from the bits of byte `b`, cell `k` in byte `k`
+#define WIRE_SPREAD(b) ( \
+    ((uint64_t) ((b) & 1)) | ((uint64_t) (((b) >> 1) & 1) << 8) | ((uint64_t) (((b) >> 2) & 1) << 16) | ((uint64_t) (((b) >> 3) & 1) << 24) | \
+    ((uint64_t) (((b) >> 4) & 1) << 32) | ((uint64_t) (((b) >> 5) & 1) << 40) | ((uint64_t) (((b) >> 6) & 1) << 48) | ((uint64_t) (((b) >> 7) & 1) << 56))
+// Table of all the bytes, built by the preprocessor the way rule.c builds its tables
+#define WIRE_T4(b) WIRE_SPREAD(b), WIRE_SPREAD((b) + 1), WIRE_SPREAD((b) + 2), WIRE_SPREAD((b) + 3)
+#define WIRE_T16(b) WIRE_T4(b), WIRE_T4((b) + 4), WIRE_T4((b) + 8), WIRE_T4((b) + 12)
+#define WIRE_T64(b) WIRE_T16(b), WIRE_T16((b) + 16), WIRE_T16((b) + 32), WIRE_T16((b) + 48)
+
+// Word of 8 cells (0 or 1) for each byte of bits. Constant, so any number of threads can decode at once
+static const uint64_t wire_spread[256] = {WIRE_T64(0), WIRE_T64(64), WIRE_T64(128), WIRE_T64(192)};
+
+
+// Bit `k` of the result is the low bit of `cells[k]`: SIMD within a register, one multiply for 8 cells
+static uint8_t wire_gather(const uint8_t cells[8]) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    uint64_t word;
+    memcpy(&word, cells, sizeof(word));
+    return (uint8_t) (((word & WIRE_LOW_BITS) * WIRE_GATHER) >> 56);
+#else
+    uint8_t byte = 0;
+    for(int k = 0; k < 8; k++) {
+        byte |= (cells[k] & 1) << k;
+    }
+    return byte;
+#endif
+}
+
+
+// Next byte of bits, from up to 8 cells
+static uint8_t wire_next_byte(const uint8_t* cells, int n, int stride) {
+    // Full rows are gathered in place
+    if(n == 8 && stride == 1) {
+        return wire_gather(cells);
+    }
+
+    uint8_t group[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+    for(int k = 0; k < n; k++) {
+        group[k] = cells[(size_t) k * stride];
+    }
+    return wire_gather(group);
+}
+
+
+// Writes up to 8 cells from a byte of bits
+static void wire_put_byte(uint8_t byte, uint8_t* cells, int n, int stride, uint8_t alive) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    if(n == 8 && stride == 1) {
+        // Each byte of the word is 0 or 1, so the product never carries into the next one
+        uint64_t word = wire_spread[byte] * alive;
+        memcpy(cells, &word, sizeof(word));
+        return;
+    }
+#endif
+    for(int k = 0; k < n; k++) {
+        cells[(size_t) k * stride] = ((byte >> k) & 1) ? alive : 0;
+    }
+}
+
+
+int wire_encode(int format, const uint8_t* cells, int count, int stride, uint8_t* out) {
+    if(format == WIRE_RAW) {
+        if(stride == 1) {
+            memcpy(out, cells, count * sizeof(uint8_t));
+        }
+        else {
+            for(int i = 0; i < count; i++) {
+                out[i] = cells[(size_t) i * stride];
+            }
+        }
+        return count;
+    }
+
+    int bytes = 0;
+    int run = 0; // empty bytes not written yet (RLE)
+    for(int i = 0; i < count; i += 8) {
+        uint8_t byte = wire_next_byte(cells + (size_t) i * stride, MIN(8, count - i), stride);
+
+        if(format == WIRE_BITS) {
+            out[bytes++] = byte;
+            continue;
+        }
+
+        // RLE: an empty byte is followed by the length of its run (up to 255), any other byte goes as it is
+        if(byte == 0) {
+            if(++run == 255) {
+                out[bytes++] = 0;
+                out[bytes++] = run;
+                run = 0;
+            }
+            continue;
+        }
+        if(run > 0) {
+            out[bytes++] = 0;
+            out[bytes++] = run;
+            run = 0;
+        }
+        out[bytes++] = byte;
+    }
+    if(run > 0) {
+        out[bytes++] = 0;
+        out[bytes++] = run;
+    }
+
+    return bytes;
+}
+
+
+void wire_decode(int format, const uint8_t* in, int bytes, int count, uint8_t* cells, int stride, uint8_t alive) {
+    if(format == WIRE_RAW) {
+        if(stride == 1) {
+            memcpy(cells, in, count * sizeof(uint8_t));
+        }
+        else {
+            for(int i = 0; i < count; i++) {
+                cells[(size_t) i * stride] = in[i];
+            }
+        }
+        return;
+    }
+
+    int i = 0;
+    for(int at = 0; at < bytes && i < count;) {
+        uint8_t byte = in[at++];
+        int repeat = 1;
+        if(format == WIRE_RLE && byte == 0) {
+            repeat = in[at++];
+        }
+
+        for(int r = 0; r < repeat && i < count; r++, i += 8) {
+            wire_put_byte(byte, cells + (size_t) i * stride, MIN(8, count - i), stride, alive);
+        }
+    }
+}
+
+
+void wire_encode_rows(int format, const uint8_t* cells, int rows, int cols, int row_len, uint8_t* out) {
+    if(format == WIRE_RLE) format = WIRE_BITS;
+
+    int row_bytes = WIRE_ROWS_SIZE(format, 1, cols);
+    for(int i = 0; i < rows; i++) {
+        wire_encode(format, cells + (size_t) i * row_len, cols, 1, out + (size_t) i * row_bytes);
+    }
+}
+
+
+void wire_decode_rows(int format, const uint8_t* in, int rows, int cols, int row_len, uint8_t* cells, uint8_t alive) {
+    if(format == WIRE_RLE) format = WIRE_BITS;
+
+    int row_bytes = WIRE_ROWS_SIZE(format, 1, cols);
+    for(int i = 0; i < rows; i++) {
+        wire_decode(format, in + (size_t) i * row_bytes, row_bytes, cols, cells + (size_t) i * row_len, 1, alive);
+    }
+}
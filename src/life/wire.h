@@ -0,0 +1,41 @@
+#ifndef _WIRE
+#define _WIRE
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* Constants */
+// Format of the cells in halo and block messages (`--wire`)
+#define WIRE_RAW  0 // the whole cell byte
+#define WIRE_BITS 1 // alive bits only, 8 cells per byte
+#define WIRE_RLE  2 // alive bits, with the runs of empty bytes run-length encoded
+
+/* Macros */
+// Bytes of `cells` cells packed as bits
+#define WIRE_BITS_SIZE(cells) (((cells) + 7) / 8)
+// Bytes of `cells` cells in any format. RLE doubles isolated empty bytes at worst
+#define WIRE_MAX_SIZE(cells) ((cells) + 2 * WIRE_BITS_SIZE(cells))
+// Bytes of a `rows` x `cols` area encoded with `wire_encode_rows(...)`
+#define WIRE_ROWS_SIZE(format, rows, cols) ((format) == WIRE_RAW ? (size_t) (rows) * (cols) : (size_t) (rows) * WIRE_BITS_SIZE(cols))
+
+/* Encoding */
+// Encodes `count` cells, `stride` apart, into `out` (`WIRE_MAX_SIZE(count)` bytes). Returns the bytes written
+/*
+    Args:
+        int: format (`WIRE_RAW`, `WIRE_BITS`, `WIRE_RLE`)
+        const uint8_t*: first cell
+        int: cells to encode
+        int: distance between two cells (1 for a row, the row length for a column)
+        uint8_t*: where the message goes
+    **NOTE:**:
+        - Bit `k` of byte `b` is cell `8 * b + k`
+*/
+int wire_encode(int format, const uint8_t* cells, int count, int stride, uint8_t* out);
+// Decodes the `bytes` of a message into `count` cells, `stride` apart. Set bits become `alive`, the others 0
+void wire_decode(int format, const uint8_t* in, int bytes, int count, uint8_t* cells, int stride, uint8_t alive);
+// Same, for a `rows` x `cols` area of a buffer with rows `row_len` cells long, one row after the other
+// Every row starts on a byte, and RLE areas go as plain bits, so the size is known beforehand (`WIRE_ROWS_SIZE(...)`), as collectives need
+void wire_encode_rows(int format, const uint8_t* cells, int rows, int cols, int row_len, uint8_t* out);
+void wire_decode_rows(int format, const uint8_t* in, int rows, int cols, int row_len, uint8_t* cells, uint8_t alive);
+
+#endif
@@ -2,441 +2,2256 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <errno.h>
 #include <mpi.h>
 
 #include "life/life.h"
+#include "life/rgen.h"
+#include "life/cycle.h"
+#include "life/mem.h"
+#include "life/tile.h"
+#include "life/block.h"
+#include "life/stream.h"
+#include "life/ooc.h"
+#include "life/tune.h"
+#include "life/frontier.h"
+#include "life/sched.h"
+#include "life/dmap.h"
+#include "life/region.h"
 
 // #define DEBUG
 
+#define MODE_SERIAL 0x1
+#define MODE_1D     0x2
+#define MODE_2D     0x4
+#define MODE_OOC    0x8
+#define MODE_AUTO   0x10
+#define MODE_THREADS 0x20
+
+// Control messages that are not a run
+#define CONTROL_STATS 0x100
+#define CONTROL_DONE  0x200
+
+#define SWEEP_DEFAULT_OUT "sweep.csv"
+#define BATCH_DEFAULT_OUT "batch.csv"
+
 /*
-    Compile:
-    gcc -Wall -g src/main.c src/life/life.h src/life/life.c -I "c:\Program Files (x86)\Microsoft SDKs\MPI\Include" -L "c:\Program Files (x86)\Microsoft SDKs\MPI\Lib\x64" -lmsmpi -o life_mpi.exe
+    Build with the Makefile at the root: `make liblife` for the core library (no MPI, see src/life/engine.h), `make life_mpi` for this driver on top of it
 */
 
 
-int rank = -1;
+int world_rank = -1;
+MPI_Comm comm; // processes of the current configuration, the whole world or a sweep sub-communicator
+int rank = -1; // rank in `comm`
 int comm_size = -1, worker_cnt = -1;
 
 int rows = -1, columns = -1;
 int rows_real = -1, cols_real = -1;
-uint8_t* serial_buffer = NULL;
-uint8_t* parallel_1d_buffer = NULL;
-uint8_t* parallel_2d_buffer = NULL;
+uint8_t* initial_buffer = NULL; // generation 0, every run starts from a copy of it
+uint8_t* work_buffer = NULL;
+uint8_t* reference_buffer = NULL; // serial result (computed or loaded), NULL if there is none
+float reference_time = -1;
 
 int init_from[2], init_to[2];
 float tstart = -1, tend = -1, telapsed = 1;
 char* output_path = NULL;
 
+char* input_path = NULL;
+int generations = -1;
+
+// Synthetic input (`--generate`)
+int gen_width = -1, gen_height = -1;
+double gen_density = RGEN_DEFAULT_DENSITY;
+uint64_t gen_seed = RGEN_DEFAULT_SEED;
+char gen_name[128];
+
+// Early termination (`--cycle-window`, `--cycle-check`)
+int cycle_window = 0;
+int cycle_check = CYCLE_DEFAULT_CHECK;
+
+// Verification (`--golden`)
+char* golden_path = NULL;
+char golden_key[128];
+
+// Workers hash their blocks if either early termination or verification needs it
+int use_hash = 0;
+
+// Version selection (`--modes`, `--repeat`, `--reference`)
+int run_modes = MODE_SERIAL | MODE_1D | MODE_2D;
+int repetitions = 1;
+char* reference_path = NULL;
+
+// Scaling sweep (`--sweep`, `--sweep-out`)
+char* sweep_out = SWEEP_DEFAULT_OUT;
+int* sweep_counts = NULL;
+int sweep_cnt = 0;
+
+// Ensemble of independent universes (`--batch`, `--batch-out`)
+char* batch_path = NULL;
+char* batch_out = BATCH_DEFAULT_OUT;
+
+// Wrap-around edges (`--torus`)
+int torus = 0;
+
+// Halo exchange of the parallel versions and what its messages carry (`--halo`, `--wire`)
+int halo_mode = BLOCK_HALO_SENDRECV;
+int wire_format = WIRE_RAW;
+
+// The master streams the input to the workers and their result to the output in bands, without ever holding the universe (`--stream`)
+int stream = 0;
+
+// Out of core version: the generations live in files of this directory instead of memory (`--out-of-core`)
+char* ooc_dir = NULL;
+
+// Decomposition of the auto version (`--modes auto`, `--tune-gens`, `--tune-file`)
+int tune_gens = 0; // generations each candidate shape is timed on, 0 trusts the cost model
+char* tune_file = TUNE_DEFAULT_FILE;
+int tune_x = 1, tune_y = 1; // shape of the current run
+
+// Serial version: only the cells next to the last flips are solved while they are fewer than this fraction of the universe, 0 always sweeps it (`--frontier`)
+double frontier_density = 0;
+
+// Population statistics of every generation, written next to the output (`--stats`)
+int use_stats = 0;
+
+// Live fraction of every `map_side * map_side` block, written as a frame every `map_every` generations, 0 for none (`--density-map`, `--map-every`, `--map-out`)
+int map_side = 0;
+int map_every = DMAP_DEFAULT_EVERY;
+char* map_out = NULL; // file or named pipe, instead of one file per version next to the outputs
+
+// Regions of interest in the padded universe, written every `region_every` generations (0 for the last one only) without gathering the universe (`--roi`, `--roi-every`)
+area_t regions[REGION_MAX];
+int region_cnt = 0;
+int region_every = 0;
+
+// Threaded version: threads of the master's pool, 0 for one per online processor (`--modes threads`, `--threads`)
+int threads = 0;
+
+// Cache tiling (`--tile`, `--time-block`)
+int tile_size = 0;
+int time_block = TILE_DEFAULT_DEPTH;
+
+// State of the last run
+uint64_t run_hash = 0;
+gen_stats_t* run_stats = NULL; // one per generation, if `use_stats`
+dmap_t run_map = {0}; // counts kept from one run to the next, if `map_side`
+FILE* run_map_file = NULL;
+int run_map_frames = 0;
+uint8_t* run_region = NULL; // cells of the largest region, where the master receives them
+int run_region_files = 0;
+char* run_type = NULL; // `out_type` of the running version, what the files of the regions are named after
+int run_allocs[2] = {0, 0}; // heap allocations of all the processes, up to the end of the first generation and after it
+int run_gens = -1;
+cycle_t* run_cycle = NULL;
+float tmean = -1;
+
+// Staging space of the master, reused by every run
+arena_t* master_arena = NULL;
+
 int job_1d_cnt = -1;
 int job_2d_cnt = -1, job_2d_width = -1;
 area_t* jobs_1d = NULL;
 area_t* jobs_2d = NULL;
 
+// Everything the workers need to know about a run, broadcast once at its start. Workers work out their own block from it
+typedef struct _control_t {
+    int mode; // `MODE_1D` or `MODE_2D` for a run, `CONTROL_STATS` or `CONTROL_DONE`
+    int rows, columns;
+    int generations;
+    int torus;
+    int halo;
+    int wire;
+    int use_hash;
+    int use_stats; // statistics of every generation, reduced to the master once per `cycle_check` generations
+    int map_side; // density map reduced to the master every `map_every` generations, 0 for none
+    int map_every;
+    int region_cnt; // regions sent to the master every `region_every` generations, and after the last one
+    int region_every;
+    area_t regions[REGION_MAX];
+    int cycle_check;
+    int stop_early; // the master may stop the run after a hash reduction (cycle detection)
+    int generate; // workers draw their blocks themselves (`--generate`), nothing is scattered, and only gathered if streamed
+    int stream; // rows of the bands the blocks are streamed in (`--stream`), 0 if they are scattered
+    int workers_x, workers_y; // blocks across and down (`MODE_AUTO`)
+    int tile; // side of the tiles of the blocks, 0 if they are not tiled
+    int time_block; // generations a tile is advanced while it is in cache, the deepest the halos of a block get (see `block_depth(...)`)
+
+    double density;
+    uint64_t seed;
+} control_t;
+
+MPI_Datatype control_type = MPI_DATATYPE_NULL;
+// `BLOCK_UNIT` bytes, what blocks are scattered and gathered in
+MPI_Datatype unit_type = MPI_DATATYPE_NULL;
+// One `gen_stats_t`, and how the parts of a generation add up (`stats_merge(...)`)
+MPI_Datatype stats_type = MPI_DATATYPE_NULL;
+MPI_Op stats_op = MPI_OP_NULL;
+
 
 void usage(char* prg) {
     printf("Usage:mpiexec -n <prc_cnt> %s <file_in> <num_gens>\n", prg);
+    printf("      mpiexec -n <prc_cnt> %s --generate <W>x<H> [--density <p>] [--seed <s>] <num_gens>\n", prg);
+    printf("      mpiexec -n <prc_cnt> %s --batch <manifest|dir> [--batch-out <file>] <num_gens>\n", prg);
+    printf("Options:\n");
+    printf("  --cycle-window <w>    stop once the universe repeats a state from the last <w> generations\n");
+    printf("  --cycle-check <k>     generations between two global hash reductions (default %d)\n", CYCLE_DEFAULT_CHECK);
+    printf("  --golden <file>       check the final state of every version against the golden hash stored in <file>\n");
+    printf("  --modes <list>        comma separated versions to run: serial, 1d, 2d, auto, threads (default serial,\n");
+    printf("                        1d and 2d)\n");
+    printf("  --repeat <r>          run every version <r> times, timing each repetition\n");
+    printf("  --reference <file>    serial output of a previous run, used instead of running the serial version\n");
+    printf("  --sweep <list>        run the parallel versions once per worker count in <list> (comma separated, or `auto`\n");
+    printf("                        for every multiple of %d) inside this launch, on sub-communicators\n", MINIMUM_2D);
+    printf("  --sweep-out <file>    where the sweep results go, JSON if <file> ends in `.json`, CSV otherwise (default %s)\n", SWEEP_DEFAULT_OUT);
+    printf("  --rule <rule>         B/S rule, `V` at the end for von Neumann neighbourhoods, or one of life, highlife,\n");
+    printf("                        seeds, daynight (default %s)\n", RULE_DEFAULT);
+    printf("  --batch <path>        run every universe listed in the manifest <path> (one file per line), or every `.txt`\n");
+    printf("                        file of the directory <path>, each on one process with the serial version\n");
+    printf("  --batch-out <file>    where the results of a batch go, as CSV (default %s)\n", BATCH_DEFAULT_OUT);
+    printf("  --tune-gens <g>       the auto version times the %d cheapest shapes of its cost model on <g> generations\n", TUNE_CANDIDATES);
+    printf("                        each and keeps the fastest (default 0, the model alone decides)\n");
+    printf("  --tune-file <file>    where the auto version caches its shape per universe size and rank count (default\n");
+    printf("                        %s)\n", TUNE_DEFAULT_FILE);
+    printf("  --torus               the edges of the universe wrap around instead of being dead\n");
+    printf("  --frontier <d>        the serial version only solves the cells next to the last flips, sweeping the whole\n");
+    printf("                        universe while they are more than <d> of it (e.g. %.2f)\n", FRONTIER_DEFAULT_DENSITY);
+    printf("  --stats               population, births, deaths and box of the alive cells of every generation, counted\n");
+    printf("                        by the solver and written as CSV next to the output (not with --frontier)\n");
+    printf("  --density-map <s>     write the live fraction of every <s> x <s> block as a PGM frame, counted by the solver\n");
+    printf("  --map-every <n>       generations between two frames of the density map (default %d)\n", DMAP_DEFAULT_EVERY);
+    printf("  --map-out <file>      file or named pipe the frames go to (default one file per version next to the output)\n");
+    printf("  --roi <x>,<y>,<w>,<h> write the <w> x <h> cells from column <x> and row <y> (from 0) without gathering the\n");
+    printf("                        universe, after the last generation (up to %d regions, the option repeated)\n", REGION_MAX);
+    printf("  --roi-every <n>       also write the regions every <n> generations\n");
+    printf("  --threads <n>         threads of the threaded version (default one per online processor)\n");
+    printf("  --tile <t>            solve and update the universe in <t> x <t> tiles (serial, threaded and batch runs, and the\n");
+    printf("                        blocks of the workers with sendrecv halos)\n");
+    printf("  --time-block <k>      generations a tile is advanced while it is in cache, and depth of the workers' halos\n");
+    printf("                        when they are tiled (default %d)\n", TILE_DEFAULT_DEPTH);
+    printf("  --halo <exchange>     how the workers exchange halos: sendrecv (default), shm (blocks of a node in one\n");
+    printf("                        shared memory window, read directly by their neighbours) or rma (neighbours put their\n");
+    printf("                        edges into the block's window, post-start-complete-wait)\n");
+    printf("  --stream              parallel versions only: the master parses the input and writes the output in bands of\n");
+    printf("                        %d MB, sent to and received from the workers that own them, never holding the universe\n", STREAM_BAND_SIZE >> 20);
+    printf("  --out-of-core <dir>   only run the out of core version: both generations are memory mapped files in the\n");
+    printf("                        existing directory <dir>, solved by the master in bands of %d MB\n", OOC_BAND_SIZE >> 20);
+    printf("  --wire <format>       cells in the halo and block messages: bytes (whole cells, default), bits (alive bits)\n");
+    printf("                        or rle (alive bits, runs of empty bytes run-length encoded in the halos)\n");
+    printf("  --hugepages <pages>   backing of the buffers of %d MB or more: none, thp (default) or explicit (MAP_HUGETLB,\n", MEM_LARGE >> 20);
+    printf("                        falling back to thp)\n");
     fflush(stdout);
 }
 
 
-int main(int argc, char** argv) {
-    MPI_Init(&argc, &argv);
+// Parses the command line into the globals above. Returns 0 on success, -1 otherwise (the reason is printed if `verbose`)
+int parse_args(int argc, char** argv, int verbose) {
+    char* positional[2] = {NULL, NULL};
+    int npositional = 0;
+    char* endptr = NULL;
 
-    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    for(int i = 1; i < argc; i++) {
+        if(strcmp(argv[i], "--generate") == 0 && i + 1 < argc) {
+            char extra;
+            if(sscanf(argv[++i], "%dx%d%c", &gen_width, &gen_height, &extra) != 2 || gen_width < 1 || gen_height < 1) {
+                if(verbose) printf("`--generate` expects `<W>x<H>` with positive sizes. Got `%s`\n", argv[i]);
+                return -1;
+            }
+        }
+        else if(strcmp(argv[i], "--density") == 0 && i + 1 < argc) {
+            gen_density = strtod(argv[++i], &endptr);
+            if(strlen(endptr) > 0 || gen_density < 0 || gen_density > 1) {
+                if(verbose) printf("`--density` should be a number in [0, 1]. Got `%s`\n", argv[i]);
+                return -1;
+            }
+        }
+        else if(strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            gen_seed = strtoull(argv[++i], &endptr, 10);
+            if(strlen(endptr) > 0) {
+                if(verbose) printf("`--seed` should be an unsigned integer. Got `%s`\n", argv[i]);
+                return -1;
+            }
+        }
+        else if(strcmp(argv[i], "--cycle-window") == 0 && i + 1 < argc) {
+            cycle_window = strtol(argv[++i], &endptr, 10);
+            if(strlen(endptr) > 0 || cycle_window < 0) {
+                if(verbose) printf("`--cycle-window` should be a positive integer. Got `%s`\n", argv[i]);
+                return -1;
+            }
+        }
+        else if(strcmp(argv[i], "--cycle-check") == 0 && i + 1 < argc) {
+            cycle_check = strtol(argv[++i], &endptr, 10);
+            if(strlen(endptr) > 0 || cycle_check < 1) {
+                if(verbose) printf("`--cycle-check` should be a positive integer. Got `%s`\n", argv[i]);
+                return -1;
+            }
+        }
+        else if(strcmp(argv[i], "--golden") == 0 && i + 1 < argc) {
+            golden_path = argv[++i];
+        }
+        else if(strcmp(argv[i], "--modes") == 0 && i + 1 < argc) {
+            run_modes = 0;
+
+            char modes[strlen(argv[++i]) + 1];
+            strcpy(modes, argv[i]);
+            for(char* mode = strtok(modes, ","); mode; mode = strtok(NULL, ",")) {
+                if(strcmp(mode, "serial") == 0) run_modes |= MODE_SERIAL;
+                else if(strcmp(mode, "1d") == 0) run_modes |= MODE_1D;
+                else if(strcmp(mode, "2d") == 0) run_modes |= MODE_2D;
+                else if(strcmp(mode, "auto") == 0) run_modes |= MODE_AUTO;
+                else if(strcmp(mode, "threads") == 0) run_modes |= MODE_THREADS;
+                else {
+                    if(verbose) printf("Unknown version `%s` in `--modes`\n", mode);
+                    return -1;
+                }
+            }
+        }
+        else if(strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+            repetitions = strtol(argv[++i], &endptr, 10);
+            if(strlen(endptr) > 0 || repetitions < 1) {
+                if(verbose) printf("`--repeat` should be a positive integer. Got `%s`\n", argv[i]);
+                return -1;
+            }
+        }
+        else if(strcmp(argv[i], "--reference") == 0 && i + 1 < argc) {
+            reference_path = argv[++i];
+        }
+        else if(strcmp(argv[i], "--sweep") == 0 && i + 1 < argc) {
+            free(sweep_counts);
+            sweep_cnt = 0;
+
+            if(strcmp(argv[++i], "auto") == 0) {
+                // Every multiple of MINIMUM_2D, plus the full world
+                sweep_counts = calloc(worker_cnt / MINIMUM_2D + 1, sizeof(int));
+                if(!sweep_counts) {
+                    perror("Error allocating sweep list");
+                    exit(errno);
+                }
+                for(int w = MINIMUM_2D; w <= worker_cnt; w += MINIMUM_2D) {
+                    sweep_counts[sweep_cnt++] = w;
+                }
+                if(sweep_cnt == 0 || sweep_counts[sweep_cnt - 1] != worker_cnt) {
+                    sweep_counts[sweep_cnt++] = worker_cnt;
+                }
+                continue;
+            }
 
-    MPI_Comm_size(MPI_COMM_WORLD, &comm_size);
-    worker_cnt = comm_size - 1;
+            sweep_counts = calloc(strlen(argv[i]) / 2 + 1, sizeof(int));
+            if(!sweep_counts) {
+                perror("Error allocating sweep list");
+                exit(errno);
+            }
 
-    // Main Process
-    if(rank == 0) {
-        if(argc != 3) {
-            usage(argv[0]);
-            MPI_Abort(MPI_COMM_WORLD, 0);
+            char counts[strlen(argv[i]) + 1];
+            strcpy(counts, argv[i]);
+            for(char* count = strtok(counts, ","); count; count = strtok(NULL, ",")) {
+                int w = strtol(count, &endptr, 10);
+                if(strlen(endptr) > 0 || w < 1 || w > worker_cnt) {
+                    if(verbose) printf("`--sweep` worker counts should be in [1, %d]. Got `%s`\n", worker_cnt, count);
+                    return -1;
+                }
+                sweep_counts[sweep_cnt++] = w;
+            }
+        }
+        else if(strcmp(argv[i], "--sweep-out") == 0 && i + 1 < argc) {
+            sweep_out = argv[++i];
+        }
+        else if(strcmp(argv[i], "--rule") == 0 && i + 1 < argc) {
+            if(rule_set(argv[++i]) != 0) {
+                if(verbose) printf("`--rule` expects `B<digits>/S<digits>` (0-8, or 0-4 with a trailing `V`, no B0) or a rule name. Got `%s`\n", argv[i]);
+                return -1;
+            }
+        }
+        else if(strcmp(argv[i], "--batch") == 0 && i + 1 < argc) {
+            batch_path = argv[++i];
+        }
+        else if(strcmp(argv[i], "--batch-out") == 0 && i + 1 < argc) {
+            batch_out = argv[++i];
+        }
+        else if(strcmp(argv[i], "--tune-gens") == 0 && i + 1 < argc) {
+            tune_gens = strtol(argv[++i], &endptr, 10);
+            if(strlen(endptr) > 0 || tune_gens < 0) {
+                if(verbose) printf("`--tune-gens` should be a positive integer. Got `%s`\n", argv[i]);
+                return -1;
+            }
+        }
+        else if(strcmp(argv[i], "--tune-file") == 0 && i + 1 < argc) {
+            tune_file = argv[++i];
+        }
+        else if(strcmp(argv[i], "--out-of-core") == 0 && i + 1 < argc) {
+            ooc_dir = argv[++i];
+        }
+        else if(strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = strtol(argv[++i], &endptr, 10);
+            if(strlen(endptr) > 0 || threads < 1) {
+                if(verbose) printf("`--threads` should be a positive integer. Got `%s`\n", argv[i]);
+                return -1;
+            }
+        }
+        else if(strcmp(argv[i], "--frontier") == 0 && i + 1 < argc) {
+            frontier_density = strtod(argv[++i], &endptr);
+            if(strlen(endptr) > 0 || frontier_density <= 0 || frontier_density > 1) {
+                if(verbose) printf("`--frontier` should be a fraction in (0, 1]. Got `%s`\n", argv[i]);
+                return -1;
+            }
+        }
+        else if(strcmp(argv[i], "--stats") == 0) {
+            use_stats = 1;
+        }
+        else if(strcmp(argv[i], "--density-map") == 0 && i + 1 < argc) {
+            map_side = strtol(argv[++i], &endptr, 10);
+            if(strlen(endptr) > 0 || map_side < 1) {
+                if(verbose) printf("Invalid density map block: %s\n", argv[i]);
+                return -1;
+            }
+        }
+        else if(strcmp(argv[i], "--map-every") == 0 && i + 1 < argc) {
+            map_every = strtol(argv[++i], &endptr, 10);
+            if(strlen(endptr) > 0 || map_every < 1) {
+                if(verbose) printf("Invalid density map period: %s\n", argv[i]);
+                return -1;
+            }
+        }
+        else if(strcmp(argv[i], "--map-out") == 0 && i + 1 < argc) {
+            map_out = argv[++i];
+        }
+        else if(strcmp(argv[i], "--roi") == 0 && i + 1 < argc) {
+            i++;
+            if(region_cnt == REGION_MAX || region_parse(argv[i], &regions[region_cnt]) != 0) {
+                if(verbose) printf("Invalid region (or more than %d): %s\n", REGION_MAX, argv[i]);
+                return -1;
+            }
+            region_cnt++;
+        }
+        else if(strcmp(argv[i], "--roi-every") == 0 && i + 1 < argc) {
+            region_every = strtol(argv[++i], &endptr, 10);
+            if(strlen(endptr) > 0 || region_every < 1) {
+                if(verbose) printf("Invalid region period: %s\n", argv[i]);
+                return -1;
+            }
+        }
+        else if(strcmp(argv[i], "--stream") == 0) {
+            stream = 1;
+        }
+        else if(strcmp(argv[i], "--torus") == 0) {
+            torus = 1;
+        }
+        else if(strcmp(argv[i], "--tile") == 0 && i + 1 < argc) {
+            tile_size = strtol(argv[++i], &endptr, 10);
+            if(strlen(endptr) > 0 || tile_size < 1) {
+                if(verbose) printf("`--tile` should be a positive integer. Got `%s`\n", argv[i]);
+                return -1;
+            }
+        }
+        else if(strcmp(argv[i], "--time-block") == 0 && i + 1 < argc) {
+            time_block = strtol(argv[++i], &endptr, 10);
+            if(strlen(endptr) > 0 || time_block < 1) {
+                if(verbose) printf("`--time-block` should be a positive integer. Got `%s`\n", argv[i]);
+                return -1;
+            }
         }
+        else if(strcmp(argv[i], "--hugepages") == 0 && i + 1 < argc) {
+            i++;
+            if(strcmp(argv[i], "none") == 0) mem_set_pages(MEM_PAGES_NONE);
+            else if(strcmp(argv[i], "thp") == 0) mem_set_pages(MEM_PAGES_THP);
+            else if(strcmp(argv[i], "explicit") == 0) mem_set_pages(MEM_PAGES_EXPLICIT);
+            else {
+                if(verbose) printf("`--hugepages` expects none, thp or explicit. Got `%s`\n", argv[i]);
+                return -1;
+            }
+        }
+        else if(strcmp(argv[i], "--halo") == 0 && i + 1 < argc) {
+            i++;
+            if(strcmp(argv[i], "sendrecv") == 0) halo_mode = BLOCK_HALO_SENDRECV;
+            else if(strcmp(argv[i], "shm") == 0) halo_mode = BLOCK_HALO_SHM;
+            else if(strcmp(argv[i], "rma") == 0) halo_mode = BLOCK_HALO_RMA;
+            else {
+                if(verbose) printf("`--halo` expects sendrecv, shm or rma. Got `%s`\n", argv[i]);
+                return -1;
+            }
+        }
+        else if(strcmp(argv[i], "--wire") == 0 && i + 1 < argc) {
+            i++;
+            if(strcmp(argv[i], "bytes") == 0) wire_format = WIRE_RAW;
+            else if(strcmp(argv[i], "bits") == 0) wire_format = WIRE_BITS;
+            else if(strcmp(argv[i], "rle") == 0) wire_format = WIRE_RLE;
+            else {
+                if(verbose) printf("`--wire` expects bytes, bits or rle. Got `%s`\n", argv[i]);
+                return -1;
+            }
+        }
+        else if(strncmp(argv[i], "--", 2) == 0) {
+            if(verbose) printf("Unknown or incomplete option `%s`\n", argv[i]);
+            return -1;
+        }
+        else if(npositional < 2) {
+            positional[npositional++] = argv[i];
+        }
+        else {
+            if(verbose) printf("Too many arguments\n");
+            return -1;
+        }
+    }
+
+    // <file_in> is replaced by `--generate` or `--batch`
+    int expected = gen_width > 0 || batch_path ? 1 : 2;
+    if(npositional != expected) {
+        return -1;
+    }
 
-        // if(comm_size < 1) {
-        //     printf("At least one processes needed. Got %d instead\n", comm_size);
-        //     fflush(stdout);
-        //     MPI_Abort(MPI_COMM_WORLD, 0);
-        // }
+    if(batch_path && (gen_width > 0 || golden_path || sweep_cnt > 0 || use_stats || map_side > 0 || region_cnt > 0)) {
+        if(verbose) printf("`--batch` cannot be combined with `--generate`, `--golden`, `--sweep`, `--stats`, `--density-map` or `--roi`\n");
+        return -1;
+    }
 
-        // argv[2]: Number of generations
-        int generations = -1;
-        char* endptr = NULL;
+    // The change list does not go through the whole universe, so it has no statistics of its own
+    if(use_stats && frontier_density > 0) {
+        if(verbose) printf("`--stats` cannot be combined with `--frontier`\n");
+        return -1;
+    }
 
-        generations = strtol(argv[2], &endptr, 10);
-        if(strlen(endptr) > 0) {
-            printf("`<num_gens>` should be an integer");
-            fflush(stdout);
-            MPI_Abort(MPI_COMM_WORLD, -1);
+    if(stream && (batch_path || sweep_cnt > 0 || reference_path)) {
+        if(verbose) printf("`--stream` cannot be combined with `--batch`, `--sweep` or `--reference`\n");
+        return -1;
+    }
+    if(gen_width > 0 && reference_path) {
+        if(verbose) printf("`--generate` cannot be combined with `--reference`\n");
+        return -1;
+    }
+    if(stream || gen_width > 0) {
+        // The serial and threaded versions need the whole universe
+        run_modes &= ~(MODE_SERIAL | MODE_THREADS);
+        if(!run_modes) {
+            if(verbose) printf("`%s` only runs the parallel versions\n", stream ? "--stream" : "--generate");
+            return -1;
         }
+    }
 
-        // argv[1]: Input file name
-        serial_buffer = fload_gen(argv[1], &rows, &columns);
+    if(ooc_dir && (gen_width > 0 || batch_path || sweep_cnt > 0 || reference_path || stream)) {
+        if(verbose) printf("`--out-of-core` cannot be combined with `--generate`, `--batch`, `--sweep`, `--reference` or `--stream`\n");
+        return -1;
+    }
+    if(ooc_dir) {
+        run_modes = MODE_OOC;
+    }
 
-        rows_real = rows + 2;
-        cols_real = columns + 2;
+    // <num_gens>: Number of generations
+    generations = strtol(positional[expected - 1], &endptr, 10);
+    if(strlen(endptr) > 0) {
+        if(verbose) printf("`<num_gens>` should be an integer\n");
+        return -1;
+    }
 
-        init_from[0] = 0; init_from[1] = 0;
-        init_to[0] = cols_real - 1; init_to[1] = rows_real - 1;
+    if(batch_path) {
+        // Every universe of the batch has its own name
+        input_path = NULL;
+        golden_key[0] = '\0';
+    }
+    else if(gen_width > 0) {
+        // Outputs are named after the generator parameters, as if they were read from a file
+        snprintf(gen_name, sizeof(gen_name), "gen%dx%d_d%g_s%llu.txt", gen_width, gen_height, gen_density, (unsigned long long) gen_seed);
+        input_path = gen_name;
 
-        parallel_1d_buffer = get_chunk(serial_buffer, rows_real, cols_real, init_from, init_to);
-        parallel_2d_buffer = get_chunk(serial_buffer, rows_real, cols_real, init_from, init_to);
+        snprintf(golden_key, sizeof(golden_key), "gen%dx%d_d%g_s%llu", gen_width, gen_height, gen_density, (unsigned long long) gen_seed);
+    }
+    else {
+        input_path = positional[0];
 
-        #ifdef DEBUG
-        printf("Initial generation serial:\n\n");
-        mprint_binc(serial_buffer, rows_real, cols_real, 'X', '.');
-        printf("\n---\t---\t---\n\n");
+        // Golden hashes are keyed by the input's file name
+        char* base = strrchr(input_path, '/');
+        if(!base) base = strrchr(input_path, '\\');
+        snprintf(golden_key, sizeof(golden_key), "%s", base ? base + 1 : input_path);
+    }
 
-        printf("Initial generation parallel 1d:\n\n");
-        mprint_binc(serial_buffer, rows_real, cols_real, 'X', '.');
-        printf("\n---\t---\t---\n\n");
+    // Other rules and boundaries give other results
+    if(strcmp(rule_get()->name, RULE_DEFAULT) != 0) {
+        int len = strlen(golden_key);
+        snprintf(golden_key + len, sizeof(golden_key) - len, ":%s", rule_get()->name);
+    }
+    if(torus) {
+        int len = strlen(golden_key);
+        snprintf(golden_key + len, sizeof(golden_key) - len, ":torus");
+    }
 
-        printf("Initial generation parallel 2d:\n\n");
-        mprint_binc(serial_buffer, rows_real, cols_real, 'X', '.');
-        printf("\n---\t---\t---\n\n");
-        #endif
+    use_hash = cycle_window > 0 || golden_path;
 
-        // --- Serial Version ---
-        printf("\n\n-------\tSERIAL VERSION\t-------\n\n");
+    return 0;
+}
 
-        #ifdef DEBUG
-        printf("Initial generation:\n\n");
-        mprint_binc(serial_buffer, rows_real, cols_real, 'X', '.');
-        printf("\n---\t---\t---\n\n");
-        #endif
 
-        tstart = MPI_Wtime();
-        for(int gen = 0; gen < generations; gen++) {
-            next_gen(serial_buffer, rows_real, cols_real);
+// `MPI_User_function` of `stats_op`
+void reduce_stats_op(void* in, void* inout, int* len, MPI_Datatype* type) {
+    // Only ever called on `stats_type`
+    (void) type;
 
-            #ifdef DEBUG
-            printf("Generation %d:\n\n", gen + 1);
-            mprint_binc(serial_buffer, rows_real, cols_real, 'X', '.');
-            printf("\n---\t---\t---\n\n");
-            #endif
-        }
-        tend = MPI_Wtime();
+    for(int i = 0; i < *len; i++) {
+        stats_merge((gen_stats_t*) inout + i, (gen_stats_t*) in + i);
+    }
+}
 
-        telapsed = tend - tstart;
-        printf("End result:\n");
-        printf("* Time elapsed: %f [s]\n\n", telapsed);
-        #ifdef DEBUG
-        mprint_binc(serial_buffer, rows_real, cols_real, 'X', '.');
-        #endif
-        printf("\n---\t---\t---\n\n");
 
-        output_path = get_output_path(argv[1], "serial");
-        fwrite_gen(output_path, serial_buffer, rows_real, cols_real, telapsed);
-        free(output_path);
+// Describes `control_t` to MPI, so a whole control message goes out in one broadcast, whatever the padding of the struct. Also creates `unit_type`, `stats_type` and `stats_op`
+// NOTE: Do NOT forget to free them with `free_types()`
+void create_types() {
+    int lengths[] = {(offsetof(control_t, density) - offsetof(control_t, mode)) / sizeof(int), 1, 1};
+    MPI_Aint displs[] = {offsetof(control_t, mode), offsetof(control_t, density), offsetof(control_t, seed)};
+    MPI_Datatype types[] = {MPI_INT, MPI_DOUBLE, MPI_UINT64_T};
 
-        // -- Parallel version 1 - 1D data decomposition --
-        // Execution check
-        if(worker_cnt == 0) {
-            printf("At least 1 worker needed for parallel versions\n"); fflush(stdout);
-            goto final_mpi;
-        }
-        if(worker_cnt < MINIMUM_1D) {
-            printf("At least %d workers needed for parallel version 1D. Got %d\n", MINIMUM_1D, worker_cnt); fflush(stdout);
-            goto done_msg;
-        }
+    MPI_Type_create_struct(3, lengths, displs, types, &control_type);
+    MPI_Type_commit(&control_type);
 
-        printf("\n\n-------\tPARALLEL VERSION - 1D\t-------\n\n");
-        fflush(stdout);
-        jobs_1d = create_jobs_1d(rows, columns, worker_cnt, &job_1d_cnt);
-        // print_areas(jobs_1d, job_1d_cnt);
+    MPI_Type_contiguous(BLOCK_UNIT, MPI_UINT8_T, &unit_type);
+    MPI_Type_commit(&unit_type);
 
-        #ifdef DEBUG
-        printf("Initial generation:\n\n");
-        mprint_binc(parallel_1d_buffer, rows_real, cols_real, 'X', '.');
-        printf("\n---\t---\t---\n\n");
-        #endif
+    int stats_lengths[] = {3, 4};
+    MPI_Aint stats_displs[] = {offsetof(gen_stats_t, population), offsetof(gen_stats_t, min_x)};
+    MPI_Datatype stats_types[] = {MPI_LONG_LONG, MPI_INT};
+    MPI_Datatype stats_struct;
+    MPI_Type_create_struct(2, stats_lengths, stats_displs, stats_types, &stats_struct);
+    MPI_Type_create_resized(stats_struct, 0, sizeof(gen_stats_t), &stats_type);
+    MPI_Type_commit(&stats_type);
+    MPI_Type_free(&stats_struct);
 
-        tstart = MPI_Wtime();
-        for(int gen = 0; gen < generations; gen++) {
-            // Notifies workers of work mode
-            for(int i = 0; i < job_1d_cnt; i++) {
-                MPI_Send(&job_1d_cnt, 1, MPI_INT, i + 1, PARALLEL_1D_TAG, MPI_COMM_WORLD);
-            }
-            for(int i = job_1d_cnt; i < worker_cnt; i++) {
-                MPI_Send(&job_1d_cnt, 1, MPI_INT, i + 1, WAIT_TAG, MPI_COMM_WORLD);
-            }
+    MPI_Op_create(reduce_stats_op, 1, &stats_op);
+}
 
-            // Send data to workers
-            for(int i = 0; i < job_1d_cnt; i++) {
-                int worker_id = i + 1;
 
-                int job_rows = jobs_1d[i].to[1] - jobs_1d[i].from[1] + 1;
-                MPI_Send(&job_rows, 1, MPI_INT, worker_id, HEADER_TAG, MPI_COMM_WORLD);
+void free_types() {
+    MPI_Type_free(&control_type);
+    MPI_Type_free(&unit_type);
+    MPI_Type_free(&stats_type);
+    MPI_Op_free(&stats_op);
+}
 
-                if(_ldebug) {
-                    printf("[master]: Sent rows to worker [%d]: %d\n", worker_id, job_rows);
-                }
 
-                int job_cols = columns;
-                MPI_Send(&job_cols, 1, MPI_INT, worker_id, HEADER_TAG, MPI_COMM_WORLD);
+// Broadcasts the control message of a run (or of `CONTROL_STATS` / `CONTROL_DONE`) to the workers of `comm`
+control_t send_control(int mode) {
+    control_t control = {
+        mode: mode,
+        rows: rows,
+        columns: columns,
+        generations: generations,
+        torus: torus,
+        halo: halo_mode,
+        wire: wire_format,
+        use_hash: use_hash,
+        use_stats: use_stats,
+        map_side: map_side,
+        map_every: map_every,
+        region_cnt: region_cnt,
+        region_every: region_every,
+        cycle_check: cycle_check,
+        stop_early: cycle_window > 0,
+        generate: gen_width > 0,
+        stream: stream ? STREAM_BAND_ROWS(columns) : 0,
+        workers_x: tune_x,
+        workers_y: tune_y,
+        tile: tile_size,
+        time_block: time_block,
+        density: gen_density,
+        seed: gen_seed
+    };
+    memcpy(control.regions, regions, sizeof(regions));
+
+    MPI_Bcast(&control, 1, control_type, 0, comm);
+    return control;
+}
 
-                if(_ldebug) {
-                    printf("[master]: Sent cols to worker [%d]: %d\n", worker_id, job_cols);
-                }
 
-                uint8_t* job_data = get_chunk(parallel_1d_buffer, rows_real, cols_real, jobs_1d[i].from, jobs_1d[i].to);
-                MPI_Send(job_data, job_rows * job_cols, MPI_UINT8_T, worker_id, HEADER_TAG, MPI_COMM_WORLD);
+// Collects the hash deltas of the last `batch` generations (ending with `last_gen`) from all the workers and feeds them to the detector. Returns the detected period
+// Workers know when the reductions happen, so nothing has to be sent beforehand
+int reduce_hashes(cycle_t* cycle, uint64_t* hash, int last_gen, int batch) {
+    // The master has no cells of its own
+    uint64_t local[batch];
+    uint64_t deltas[batch];
+    memset(local, 0, sizeof(local));
 
-                if(_ldebug) {
-                    printf("[master]: Sent data to worker [%d]: %d (len)\n", worker_id, job_rows * job_cols);
-                }
+    MPI_Allreduce(local, deltas, batch, MPI_UINT64_T, MPI_BXOR, comm);
 
-                free(job_data);
-            }
+    for(int b = 0; b < batch; b++) {
+        *hash ^= deltas[b];
+        if(cycle) {
+            cycle_push(cycle, last_gen - batch + 1 + b, *hash);
+        }
+    }
 
-            MPI_Barrier(MPI_COMM_WORLD); // Wait for solver
+    return cycle ? cycle->period : 0;
+}
 
-            MPI_Barrier(MPI_COMM_WORLD); // Wait for updater
 
-            for(int i = 0; i < job_1d_cnt; i++) {
-                int worker_id = i + 1;
+// Master: hash of the universe the workers drew themselves (`--generate`), out of the hashes of their blocks
+uint64_t reduce_drawn_hash() {
+    uint64_t none = 0, hash = 0;
+    MPI_Reduce(&none, &hash, 1, MPI_UINT64_T, MPI_BXOR, 0, comm);
+    return hash;
+}
 
-                int job_rows = jobs_1d[i].to[1] - jobs_1d[i].from[1] + 1;
-                int job_cols = columns;
-                uint8_t* job_data = calloc(job_rows * job_cols, sizeof(uint8_t));
-                if(!job_data) {
-                    perror("Failed to allocate memory for job chunks (1D)");
-                    exit(errno);
-                }
 
-                MPI_Recv(job_data, job_rows * job_cols, MPI_UINT8_T, worker_id, DATA_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+// Master's part in the reduction of the statistics of the `batch` generations up to `last_gen`, into `run_stats`
+void reduce_stats(int last_gen, int batch) {
+    // The master has no cells of its own
+    gen_stats_t local[batch];
+    for(int b = 0; b < batch; b++) {
+        stats_clear(&local[b]);
+    }
 
-                if(_ldebug) {
-                    printf("[master]: Received data from worker [%d]: %d (len)\n", worker_id, job_rows * job_cols);
-                }
+    MPI_Reduce(local, run_stats + last_gen - batch, batch, stats_type, stats_op, 0, comm);
+}
 
-                place_chunk(parallel_1d_buffer, rows_real, cols_real, job_data, jobs_1d[i].from, jobs_1d[i].to);
 
-                free(job_data);
-            }
+// Master's part in the gather of the density map of generation `gen`, then writes it as a frame
+// Each worker of `jobs` sends the blocks of the map its own block crosses into `parts`, and blocks of the map across two blocks are added up here
+void gather_map(int gen, area_t* jobs, int job_cnt, uint32_t* parts) {
+    int counts[comm_size], displs[comm_size];
+    counts[0] = displs[0] = 0;
+    for(int i = 0; i < worker_cnt; i++) {
+        counts[i + 1] = i < job_cnt ? DMAP_PART_BLOCKS(jobs[i].from, jobs[i].to, map_side) : 0;
+        displs[i + 1] = displs[i] + counts[i];
+    }
+    MPI_Gatherv(NULL, 0, MPI_UINT32_T, parts, counts, displs, MPI_UINT32_T, 0, comm);
 
-            #ifdef DEBUG
-            printf("Generation %d:\n\n", gen + 1);
-            mprint_binc(parallel_1d_buffer, rows_real, cols_real, 'X', '.');
-            printf("\n---\t---\t---\n\n");
-            #endif
-        }
-        tend = MPI_Wtime();
+    dmap_clear(&run_map);
+    for(int i = 0; i < job_cnt; i++) {
+        dmap_t part;
+        dmap_init_part(&part, rows, columns, map_side, jobs[i].from, jobs[i].to, parts + displs[i + 1]);
+        dmap_add(&run_map, &part);
+    }
 
-        telapsed = tend - tstart;
-        printf("End result:\n");
-        printf("* Time elapsed: %f [s]\n\n", telapsed);
-        #ifdef DEBUG
-        mprint_binc(parallel_1d_buffer, rows_real, cols_real, 'X', '.');
-        #endif
-        printf("\n---\t---\t---\n\n");
+    dmap_write(&run_map, run_map_file, gen);
+    run_map_frames++;
+}
 
-        free(jobs_1d);
 
-        int is_1d_correct = mequal(serial_buffer, parallel_1d_buffer, rows_real, cols_real);
+// Path of a file next to the output of a version, `<input>_<type>_<what>.<suffix>` (a suffix of 3 characters)
+// NOTE: Do NOT forget to free the returned pointer
+char* get_side_path(char* out_type, char* what, char* suffix) {
+    char type[strlen(out_type) + 1 + strlen(what) + 1];
+    sprintf(type, "%s_%s", out_type, what);
 
-        printf("Is the 1D parallel version equal to the serial version?\n");
-        if(is_1d_correct) {
-            printf("\tYES\n\t\t:)\n");
+    char* path = get_output_path(input_path, type);
+    char* where = strrchr(path, '.');
+    if(where && strlen(where) == strlen(suffix) + 1) {
+        strcpy(where + 1, suffix);
+    }
+    return path;
+}
+
+
+// Whether the regions of interest are written after generation `gen`, besides the last one
+int region_due(int gen) {
+    return region_cnt > 0 && region_every > 0 && gen > 0 && gen % region_every == 0;
+}
+
+
+// Writes the regions of interest after generation `gen` next to the output of the version, as `<input>_<type>_roi<k>_<gen>.txt`
+// They are read from `cells` (the padded universe, rows `row_len` apart), or received from the workers of `jobs` when it is NULL
+void write_regions(int gen, uint8_t* cells, int row_len, area_t* jobs, int job_cnt) {
+    for(int k = 0; k < region_cnt; k++) {
+        area_t* region = &regions[k];
+        int width = region->to[0] - region->from[0] + 1;
+        int height = region->to[1] - region->from[1] + 1;
+
+        char what[32];
+        snprintf(what, sizeof(what), "roi%d_%d", k, gen);
+        char* region_path = get_side_path(run_type, what, "txt");
+
+        if(cells) {
+            fwrite_region(region_path, cells + (size_t) region->from[1] * row_len + region->from[0], height, width, row_len);
         }
         else {
-            printf("\tNO\n\t\t:(\n");
+            region_gather(region, run_region, jobs, job_cnt, comm);
+            fwrite_region(region_path, run_region, height, width, width);
         }
-        printf("\n---\t---\t---\n\n");
-        fflush(stdout);
 
-        output_path = get_output_path(argv[1], "parallel1d");
-        fwrite_gen(output_path, parallel_1d_buffer, rows_real, cols_real, telapsed);
-        free(output_path);
+        free(region_path);
+        run_region_files++;
+    }
+}
 
 
-        // -- Parallel version 2 - 2D data decomposition --
-        // Execution check
-        if(worker_cnt < MINIMUM_2D) {
-            printf("At least %d workers needed for parallel version 2D. Got %d\n", MINIMUM_2D, worker_cnt); fflush(stdout);
-            goto done_msg;
-        }
+// Adds the heap allocations of the workers (and the master's own) during the last run to `run_allocs`
+void reduce_allocs() {
+    send_control(CONTROL_STATS);
 
-        printf("\n\n-------\tPARALLEL VERSION - 2D\t-------\n\n");
-        fflush(stdout);
-        jobs_2d = create_jobs_2d(rows, columns, worker_cnt, &job_2d_cnt, &job_2d_width);
-        // print_areas(jobs_2d, job_2d_cnt);
+    int local[2] = {0, arena_count(master_arena)};
+    int total[2] = {0, 0};
+    MPI_Reduce(local, total, 2, MPI_INT, MPI_SUM, 0, comm);
 
-        #ifdef DEBUG
-        printf("Initial generation:\n\n");
-        mprint_binc(parallel_2d_buffer, rows_real, cols_real, 'X', '.');
-        printf("\n---\t---\t---\n\n");
-        #endif
+    run_allocs[0] += total[0];
+    run_allocs[1] += total[1];
+}
 
-        tstart = MPI_Wtime();
-        for(int gen = 0; gen < generations; gen++) {
-            // Notifies workers of work mode
-            for(int i = 0; i < job_2d_cnt; i++) {
-                MPI_Send(&job_2d_cnt, 1, MPI_INT, i + 1, PARALLEL_2D_TAG, MPI_COMM_WORLD);
 
-                // Send additional data
-                MPI_Send(&job_2d_width, 1, MPI_INT, i + 1, HEADER_TAG, MPI_COMM_WORLD);
-            }
-            for(int i = job_2d_cnt; i < worker_cnt; i++) {
-                MPI_Send(&job_2d_cnt, 1, MPI_INT, i + 1, WAIT_TAG, MPI_COMM_WORLD);
-            }
+// Checks the final hash of a version against the golden hash of the input. A reference version (the serial one) records the entry if it is missing
+void verify_golden(char* version, uint64_t hash, int gens, int is_reference) {
+    if(!golden_path) return;
+
+    uint64_t golden = 0;
+    if(!fload_golden(golden_path, golden_key, gens, &golden)) {
+        if(is_reference) {
+            fwrite_golden(golden_path, golden_key, gens, hash);
+            printf("Recorded the golden hash of %s after %d generations: %016llx\n", golden_key, gens, (unsigned long long) hash);
+        }
+        else {
+            printf("No golden hash for %s after %d generations\n", golden_key, gens);
+        }
+        printf("\n---\t---\t---\n\n");
+        fflush(stdout);
+        return;
+    }
 
-            // Send data to workers
-            for(int i = 0; i < job_2d_cnt; i++) {
-                int worker_id = i + 1;
+    printf("Does the %s version match the golden hash?\n", version);
+    if(hash == golden) {
+        printf("\tYES\n\t\t:)\n");
+    }
+    else {
+        printf("\tNO\n\t\t:(\n");
+    }
+    printf("\n---\t---\t---\n\n");
+    fflush(stdout);
+}
 
-                int job_rows = jobs_2d[i].to[1] - jobs_2d[i].from[1] + 1;
-                MPI_Send(&job_rows, 1, MPI_INT, worker_id, HEADER_TAG, MPI_COMM_WORLD);
 
-                if(_ldebug) {
-                    printf("[master]: Sent rows to worker [%d]: %d\n", worker_id, job_rows);
-                }
+// Starts the hash and cycle detector of a run from the state in `buffer`. A NULL `buffer` (streamed universe) starts from the hash already in `run_hash`
+void run_begin(uint8_t* buffer) {
+    run_gens = generations;
+    if(use_stats) {
+        // Kept from one run to the next, the size only changes with the universe of a batch
+        run_stats = realloc(run_stats, MAX(generations, 1) * sizeof(gen_stats_t));
+        if(!run_stats) {
+            perror("Error allocating generation statistics");
+            exit(errno);
+        }
+        for(int gen = 0; gen < generations; gen++) {
+            stats_clear(&run_stats[gen]);
+        }
+    }
+    if(map_side > 0) {
+        dmap_init(&run_map, rows, columns, map_side, realloc(run_map.counts, DMAP_SIZE(rows, columns, map_side)));
+        if(!run_map.counts) {
+            perror("Error allocating density map");
+            exit(errno);
+        }
+        run_map_frames = 0;
+    }
+    run_region_files = 0;
+    run_allocs[0] = run_allocs[1] = 0;
+    if(buffer) {
+        run_hash = use_hash ? ghash(buffer, rows_real, cols_real, init_from) : 0;
+    }
 
-                int job_cols = jobs_2d[i].to[0] - jobs_2d[i].from[0] + 1;
-                MPI_Send(&job_cols, 1, MPI_INT, worker_id, HEADER_TAG, MPI_COMM_WORLD);
+    cycle_free(run_cycle);
+    run_cycle = NULL;
+    if(cycle_window > 0) {
+        run_cycle = cycle_create(cycle_window);
+        cycle_push(run_cycle, 0, run_hash);
+    }
+}
 
-                if(_ldebug) {
-                    printf("[master]: Sent cols to worker [%d]: %d\n", worker_id, job_cols);
-                }
 
-                uint8_t* job_data = get_chunk(parallel_2d_buffer, rows_real, cols_real, jobs_2d[i].from, jobs_2d[i].to);
-                MPI_Send(job_data, job_rows * job_cols, MPI_UINT8_T, worker_id, HEADER_TAG, MPI_COMM_WORLD);
+// Generations from `gen` up to the next one the master has to see whole (the regions of interest), at most `steps` and with at most one frame of the density map among them
+int until_output(int gen, int steps) {
+    if(map_side > 0) {
+        steps = MIN(steps, 2 * map_every - 1 - gen % map_every);
+    }
+    if(region_cnt > 0 && region_every > 0) {
+        steps = MIN(steps, region_every - gen % region_every);
+    }
+    return steps;
+}
 
-                if(_ldebug) {
-                    printf("[master]: Sent data to worker [%d]: %d (len)\n", worker_id, job_rows * job_cols);
-                }
 
-                free(job_data);
-            }
+// Generation among the `steps` after `gen` (from 1) whose frame of the density map is due, 0 if none
+int frame_in(int gen, int steps) {
+    if(map_side == 0) return 0;
 
-            MPI_Barrier(MPI_COMM_WORLD); // Wait for solver
+    int frame = map_every - gen % map_every;
+    return frame <= steps ? frame : 0;
+}
 
-            MPI_Barrier(MPI_COMM_WORLD); // Wait for updater
 
-            for(int i = 0; i < job_2d_cnt; i++) {
-                int worker_id = i + 1;
-                int job_rows = jobs_2d[i].to[1] - jobs_2d[i].from[1] + 1;
-                int job_cols = jobs_2d[i].to[0] - jobs_2d[i].from[0] + 1;
-                uint8_t* job_data = calloc(job_rows * job_cols, sizeof(uint8_t));
-                if(!job_data) {
-                    perror("Failed to allocate memory for job chunks (2D)");
-                    exit(errno);
-                }
+// Serial version, in place on `buffer`. Returns the elapsed time
+float run_serial(uint8_t* buffer) {
+    run_begin(buffer);
+
+    // Temporal blocking writes into a second universe, through the local copy of one tile
+    uint64_t delta = 0;
+    uint64_t* deltas = &delta;
+    uint8_t* cells = buffer;
+    uint8_t* next = NULL;
+    uint8_t* local = NULL;
+    // The ring of a torus only holds the opposite edges for one generation, so the serial version of a torus runs untiled
+    // Same for the change list, which follows single cells
+    int tiled = tile_size > 0 && !torus && frontier_density == 0;
+    frontier_t* frontier = frontier_density > 0 ? frontier_create(rows_real, cols_real, torus, frontier_density) : NULL;
+    if(frontier_density > 0 && !frontier) {
+        perror("Error allocating frontier");
+        exit(errno);
+    }
+    if(tiled) {
+        arena_reset(master_arena, ARENA_SIZE((size_t) rows_real * cols_real) + ARENA_SIZE(TILE_LOCAL(tile_size, time_block)) + ARENA_SIZE(time_block * sizeof(uint64_t)));
+        next = arena_alloc(master_arena, (size_t) rows_real * cols_real * sizeof(uint8_t));
+        local = arena_alloc(master_arena, TILE_LOCAL(tile_size, time_block) * sizeof(uint8_t));
+        deltas = arena_alloc(master_arena, time_block * sizeof(uint64_t));
+        run_allocs[0] += arena_count(master_arena);
+    }
+    int origin[] = {0, 0};
+    int first_cell[] = {1, 1};
+
+    int last = generations;
+
+    tstart = MPI_Wtime();
+    for(int gen = 0; gen < last;) {
+        int steps = 1;
+        if(tiled) {
+            steps = MIN(time_block, generations - gen);
+            // Blocks end where the parallel versions check for cycles, so all versions can stop on the same generation
+            if(run_cycle) {
+                steps = MIN(steps, cycle_check - gen % cycle_check);
+            }
+            // And on the regions the master writes. Frames are counted by the tiles on their way
+            steps = until_output(gen, steps);
+        }
+        // Untiled runs take one generation at a time, so their frame is always the last one
+        int frame = frame_in(gen, steps);
+        if(frame) {
+            dmap_clear(&run_map);
+        }
 
-                MPI_Recv(job_data, job_rows * job_cols, MPI_UINT8_T, worker_id, DATA_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+        if(tiled) {
+            tile_gens(cells, rows_real, cols_real, NULL, next, steps, tile_size, local, origin, use_hash ? deltas : NULL, use_stats ? &run_stats[gen] : NULL, frame ? &run_map : NULL, frame);
+            swapp((void**) &cells, (void**) &next);
+        }
+        else if(frontier) {
+            delta = frontier_step(frontier, buffer, use_hash);
+        }
+        else if(use_stats) {
+            delta = snext_gen(buffer, rows_real, cols_real, torus, &run_stats[gen], frame ? &run_map : NULL);
+        }
+        else if(frame) {
+            delta = mnext_gen(buffer, rows_real, cols_real, torus, use_hash, &run_map);
+        }
+        else if(use_hash) {
+            delta = hnext_gen(buffer, rows_real, cols_real, torus);
+        }
+        else {
+            next_gen(buffer, rows_real, cols_real, torus);
+        }
 
-                if(_ldebug) {
-                    printf("[master]: Received data from worker [%d]: %d (len)\n", worker_id, job_rows * job_cols);
-                }
+        if(frame) {
+            // The change list does not go through the whole universe in a solver pass, so its map takes one of its own
+            if(frontier) {
+                dmap_count(&run_map, cells + cols_real + 1, rows, columns, cols_real, first_cell);
+            }
+            dmap_write(&run_map, run_map_file, gen + frame);
+            run_map_frames++;
+        }
+        if(region_due(gen + steps)) {
+            write_regions(gen + steps, cells, cols_real, NULL, 0);
+        }
 
-                place_chunk(parallel_2d_buffer, rows_real, cols_real, job_data, jobs_2d[i].from, jobs_2d[i].to);
+        for(int step = 0; step < steps; step++) {
+            gen++;
 
-                free(job_data);
+            if(use_hash) {
+                run_hash ^= deltas[step];
             }
 
-            #ifdef DEBUG
-            printf("Generation %d:\n\n", gen + 1);
-            mprint_binc(parallel_2d_buffer, rows_real, cols_real, 'X', '.');
-            printf("\n---\t---\t---\n\n");
-            #endif
+            if(run_cycle) {
+                cycle_push(run_cycle, gen, run_hash);
+
+                // Only stops where the parallel versions check, so all versions end on the same generation
+                if(run_cycle->period && (gen % cycle_check == 0 || gen == generations)) {
+                    run_gens = last = gen;
+                    break;
+                }
+            }
         }
-        tend = MPI_Wtime();
 
-        telapsed = tend - tstart;
-        printf("End result:\n");
-        printf("* Time elapsed: %f [s]\n\n", telapsed);
         #ifdef DEBUG
-        mprint_binc(parallel_2d_buffer, rows_real, cols_real, 'X', '.');
-        #endif
+        printf("Generation %d:\n\n", gen);
+        mprint_binc(cells, rows_real, cols_real, 'X', '.');
         printf("\n---\t---\t---\n\n");
+        #endif
+    }
 
-        free(jobs_2d);
-
-        int is_2d_correct = mequal(serial_buffer, parallel_2d_buffer, rows_real, cols_real);
+    if(cells != buffer) {
+        memcpy(buffer, cells, (size_t) rows_real * cols_real * sizeof(uint8_t));
+    }
+    if(region_cnt > 0 && !region_due(run_gens)) {
+        write_regions(run_gens, buffer, cols_real, NULL, 0);
+    }
+    tend = MPI_Wtime();
 
-        printf("Is the 2D parallel version equal to the serial version?\n");
-        if(is_2d_correct) {
-            printf("\tYES\n\t\t:)\n");
-        }
-        else {
-            printf("\tNO\n\t\t:(\n");
+    if(frontier) {
+        // Batch workers run the serial version too, only the master reports
+        if(world_rank == 0) {
+            printf("* Frontier: %lld sparse and %lld dense generations\n", frontier->sparse_gens, frontier->dense_gens);
+            fflush(stdout);
         }
-        printf("\n---\t---\t---\n\n");
-        fflush(stdout);
+        frontier_free(frontier);
+    }
 
-        output_path = get_output_path(argv[1], "parallel2d");
-        fwrite_gen(output_path, parallel_2d_buffer, rows_real, cols_real, telapsed);
-        free(output_path);
+    return tend - tstart;
+}
 
 
-        // -- Clean-up the workspace --
-        done_msg:
-        for(int i = 0; i < worker_cnt; i++) {
-            MPI_Send(&worker_cnt, 1, MPI_INT, i + 1, DONE_TAG, MPI_COMM_WORLD);
-        }
+// Threaded version, in place on `buffer` with the master's pool of threads (see sched.h). Returns the elapsed time
+float run_threaded(uint8_t* buffer) {
+    run_begin(buffer);
 
+    // Generations go to the pool in batches that end where the parallel versions check for cycles
+    int batch = run_cycle ? cycle_check : generations;
+    arena_reset(master_arena, ARENA_SIZE(batch * sizeof(uint64_t)));
+    uint64_t* deltas = arena_alloc(master_arena, batch * sizeof(uint64_t));
+    run_allocs[0] += arena_count(master_arena);
 
-        free(serial_buffer);
-        free(parallel_1d_buffer);
-        free(parallel_2d_buffer);
+    sched_t* sched = sched_create(rows_real, cols_real, torus, tile_size > 0 ? tile_size : SCHED_DEFAULT_TILE, threads);
+    if(!sched) {
+        perror("Error starting thread pool");
+        exit(errno);
     }
-    // Worker processes
-    else {
-        MPI_Status mode_status;
-        int nworkers = -1, workers_x = -1;
-
-        while(true) {
-            MPI_Recv(&nworkers, 1, MPI_INT, 0, MPI_ANY_TAG, MPI_COMM_WORLD, &mode_status);
-
-            switch(mode_status.MPI_TAG) {
-                case PARALLEL_1D_TAG:
-                    if(_ldebug) {
-                        printf("Parallel mode 1d - [%d]\n", rank);
-                        fflush(stdout);
-                    }
-                    
-                    worker_parallel_1d(rank, nworkers);
-                    
-                    break;
-                case PARALLEL_2D_TAG:
-                    if(_ldebug) {
-                        printf("Parallel mode 2d - [%d]\n", rank);
-                        fflush(stdout);
-                    }
 
-                    MPI_Recv(&workers_x, 1, MPI_INT, 0, HEADER_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-                    worker_parallel_2d(rank, nworkers, workers_x);
+    int last = generations;
 
-                    break;
-                case WAIT_TAG:
-                    if(_ldebug) {
-                        printf("Waiting for work - [%d]\n", rank);
-                        fflush(stdout);
-                    }
+    tstart = MPI_Wtime();
+    for(int gen = 0; gen < last;) {
+        // Also stops on the regions the master writes, so batches are kept in step with the cycle checks. Frames are counted by the solver on its way
+        int steps = until_output(gen, MIN(batch, generations - gen));
+        if(run_cycle) {
+            steps = MIN(steps, cycle_check - gen % cycle_check);
+        }
+        int frame = frame_in(gen, steps);
+        if(frame) {
+            dmap_clear(&run_map);
+        }
+        if(sched_gens(sched, buffer, steps, use_hash ? deltas : NULL, use_stats ? &run_stats[gen] : NULL, frame ? &run_map : NULL, frame) != 0) {
+            perror("Error allocating thread deltas");
+            exit(errno);
+        }
+
+        if(frame) {
+            dmap_write(&run_map, run_map_file, gen + frame);
+            run_map_frames++;
+        }
+        if(region_due(gen + steps)) {
+            write_regions(gen + steps, buffer, cols_real, NULL, 0);
+        }
 
-                    MPI_Barrier(MPI_COMM_WORLD);
-                    MPI_Barrier(MPI_COMM_WORLD);
+        for(int step = 0; step < steps; step++) {
+            gen++;
 
+            if(use_hash) {
+                run_hash ^= deltas[step];
+            }
+
+            if(run_cycle) {
+                cycle_push(run_cycle, gen, run_hash);
+
+                if(run_cycle->period && (gen % cycle_check == 0 || gen == generations)) {
+                    run_gens = last = gen;
                     break;
-                case DONE_TAG:
-                    if(_ldebug) {
-                        printf("DONE! - [%d]\n", rank);
-                        fflush(stdout);
-                    }
-                    goto done;
+                }
             }
         }
+    }
+    if(region_cnt > 0 && !region_due(run_gens)) {
+        write_regions(run_gens, buffer, cols_real, NULL, 0);
+    }
+    tend = MPI_Wtime();
+
+    printf("* Threads: %d, %d tiles\n", sched->thread_cnt, sched->tile_cnt);
+    fflush(stdout);
+    sched_free(sched);
+
+    return tend - tstart;
+}
+
+
+// Master's part in the generations of a parallel run over `jobs`: the hash, statistics and density map reductions, the regions of interest, and stopping the workers once a cycle is found
+void run_reductions(control_t* control, area_t* jobs, int job_cnt) {
+    if(!use_hash && !use_stats && map_side == 0 && region_cnt == 0) return;
+
+    // Room for the parts of the density map of all the workers, about the size of the map
+    uint32_t* map_parts = NULL;
+    if(map_side > 0) {
+        size_t part_blocks = 0;
+        for(int i = 0; i < job_cnt; i++) {
+            part_blocks += DMAP_PART_BLOCKS(jobs[i].from, jobs[i].to, map_side);
+        }
+        map_parts = malloc(part_blocks * sizeof(uint32_t));
+        if(!map_parts) {
+            perror("Error allocating density map parts");
+            exit(errno);
+        }
+    }
+
+    // Generation by generation, in the order of the workers: the frame of the density map, the regions, then the reductions of a batch
+    for(int gen = 1; gen <= generations; gen++) {
+        if(map_side > 0 && gen % map_every == 0) {
+            gather_map(gen, jobs, job_cnt, map_parts);
+        }
+        if(region_due(gen)) {
+            write_regions(gen, NULL, 0, jobs, job_cnt);
+        }
+        if((!use_hash && !use_stats) || (gen % cycle_check != 0 && gen != generations)) continue;
+        int batch = (gen - 1) % cycle_check + 1;
+
+        int stop = use_hash && reduce_hashes(run_cycle, &run_hash, gen, batch) != 0;
+        if(use_stats) {
+            reduce_stats(gen, batch);
+        }
+        if(control->stop_early) {
+            MPI_Bcast(&stop, 1, MPI_INT, 0, comm);
+        }
+        if(stop) {
+            run_gens = gen;
+            break;
+        }
+    }
+    free(map_parts);
+
+    if(region_cnt > 0 && !region_due(run_gens)) {
+        write_regions(run_gens, NULL, 0, jobs, job_cnt);
+    }
+}
+
+
+// Same as `run_blocks(...)`, with the blocks streamed from the input file and into the output file in bands (`--stream`). Returns the elapsed time, without writing the output
+/*
+    **NOTE:**:
+        - The master only stages 2 bands (see stream.h), and gets the hash of the universe while it parses it
+        - Every repetition writes the output, with its own time
+*/
+float run_stream(int mode, area_t* jobs, int job_cnt) {
+    int band_rows = STREAM_BAND_ROWS(columns);
+    size_t band_size = (size_t) band_rows * cols_real;
+
+    arena_reset(master_arena, 2 * ARENA_SIZE(band_size));
+    uint8_t* staging = arena_alloc(master_arena, 2 * band_size * sizeof(uint8_t));
+    // The padding columns of the bands are never sent nor received
+    memset(staging, 0, 2 * band_size * sizeof(uint8_t));
+
+    // Generated universes are only streamed out
+    int file_rows = -1, file_cols = -1;
+    FILE* in_file = gen_width > 0 ? NULL : fopen_gen(input_path, &file_rows, &file_cols);
+
+    tstart = MPI_Wtime();
+    control_t control = send_control(mode);
+    block_open(NULL, comm, control.halo);
+
+    run_hash = 0;
+    if(in_file) {
+        stream_scatter(in_file, rows, columns, jobs, job_cnt, band_rows, staging, use_hash ? &run_hash : NULL, comm);
+        fclose(in_file);
+    }
+    else if(use_hash) {
+        run_hash = reduce_drawn_hash();
+    }
+
+    run_begin(NULL);
+    run_allocs[0] += arena_count(master_arena);
+
+    run_reductions(&control, jobs, job_cnt);
+    // Nothing comes back before the output is opened, so the end of the last generation is marked with a barrier instead
+    MPI_Barrier(comm);
+    tend = MPI_Wtime();
+
+    FILE* out_file = fopen_result(output_path, tend - tstart);
+    stream_gather(out_file, rows, columns, jobs, job_cnt, band_rows, staging, comm);
+    fclose(out_file);
+
+    reduce_allocs();
+
+    return tend - tstart;
+}
+
+
+// Same as `run_blocks(...)`, for a universe the workers draw themselves (`--generate`): the master holds no grid, nothing is scattered nor gathered, and only the hash, the statistics, the density map and the regions come out. Returns the elapsed time
+float run_drawn(int mode, area_t* jobs, int job_cnt) {
+    tstart = MPI_Wtime();
+    control_t control = send_control(mode);
+    block_open(NULL, comm, control.halo);
+
+    run_hash = use_hash ? reduce_drawn_hash() : 0;
+    run_begin(NULL);
+
+    run_reductions(&control, jobs, job_cnt);
+    // Nothing comes back, so the end of the last generation is marked with a barrier
+    MPI_Barrier(comm);
+    tend = MPI_Wtime();
+
+    reduce_allocs();
+
+    return tend - tstart;
+}
+
+
+// Out of core version: both generations are files in `ooc_dir`, solved band by band by the master (see ooc.h). Returns the elapsed time, without writing the output
+float run_out_of_core(uint8_t* buffer) {
+    // No universe in memory, the version only has the signature of the others
+    (void) buffer;
+
+    ooc_t* ooc = ooc_create(ooc_dir, rows, columns, torus);
+
+    int file_rows = -1, file_cols = -1;
+    FILE* in_file = fopen_gen(input_path, &file_rows, &file_cols);
+    run_hash = 0;
+    ooc_load(ooc, in_file, use_hash ? &run_hash : NULL);
+    fclose(in_file);
+
+    run_begin(NULL);
+
+    tstart = MPI_Wtime();
+    for(int gen = 0; gen < generations;) {
+        int framed = map_side > 0 && (gen + 1) % map_every == 0;
+        if(framed) {
+            dmap_clear(&run_map);
+        }
+
+        run_hash ^= ooc_step(ooc, use_hash, use_stats ? &run_stats[gen] : NULL, framed ? &run_map : NULL);
+        gen++;
+
+        if(framed) {
+            dmap_write(&run_map, run_map_file, gen);
+            run_map_frames++;
+        }
+        // Straight from the mapped file of the current generation
+        if(region_due(gen)) {
+            write_regions(gen, ooc->maps[0], cols_real, NULL, 0);
+        }
+
+        if(run_cycle) {
+            cycle_push(run_cycle, gen, run_hash);
+
+            // Same generations as the other versions
+            if(run_cycle->period && (gen % cycle_check == 0 || gen == generations)) {
+                run_gens = gen;
+                break;
+            }
+        }
+    }
+    if(region_cnt > 0 && !region_due(run_gens)) {
+        write_regions(run_gens, ooc->maps[0], cols_real, NULL, 0);
+    }
+    tend = MPI_Wtime();
+
+    FILE* out_file = fopen_result(output_path, tend - tstart);
+    ooc_write(ooc, out_file);
+    fclose(out_file);
+
+    ooc_free(ooc);
+
+    return tend - tstart;
+}
+
+
+// Runs the parallel versions over the blocks in `jobs`, worked on by ranks 1 to `job_cnt`. Returns the elapsed time
+/*
+    **NOTE:**:
+        - Blocks go out once with `MPI_Scatterv(...)` and come back once with `MPI_Gatherv(...)`, over the blocks packed in rank order
+        - Counts and displacements are in `BLOCK_UNIT`s (`unit_type`), every block padded to a whole unit, so universes past 2 GB still fit in their `int`s
+        - Sent as bits, blocks only carry the alive bits: the workers and the master rebuild the neighbour data when they get them
+        - In between they stay on the workers, which only exchange halos, so the master just takes part in the hash reductions
+*/
+float run_blocks(uint8_t* buffer, int mode, area_t* jobs, int job_cnt) {
+    if(stream) {
+        return run_stream(mode, jobs, job_cnt);
+    }
+
+    if(!buffer) {
+        return run_drawn(mode, jobs, job_cnt);
+    }
+
+    run_begin(buffer);
+
+    // Scatter and gather tables, in units. The master and the workers with no job take part with 0 units
+    int counts[comm_size], displs[comm_size];
+    counts[0] = displs[0] = 0;
+    for(int i = 0; i < worker_cnt; i++) {
+        counts[i + 1] = i < job_cnt ? BLOCK_UNITS(WIRE_ROWS_SIZE(wire_format, jobs[i].to[1] - jobs[i].from[1] + 1, jobs[i].to[0] - jobs[i].from[0] + 1)) : 0;
+        displs[i + 1] = displs[i] + counts[i];
+    }
+    size_t total = (size_t) (displs[worker_cnt] + counts[worker_cnt]) * BLOCK_UNIT;
+
+    arena_reset(master_arena, ARENA_SIZE(total));
+    uint8_t* blocks = arena_alloc(master_arena, total * sizeof(uint8_t));
+    run_allocs[0] += arena_count(master_arena);
+
+    tstart = MPI_Wtime();
+    control_t control = send_control(mode);
+    block_open(NULL, comm, control.halo);
+
+    for(int i = 0; i < job_cnt; i++) {
+        wire_encode_rows(control.wire, buffer + (size_t) jobs[i].from[1] * cols_real + jobs[i].from[0], jobs[i].to[1] - jobs[i].from[1] + 1, jobs[i].to[0] - jobs[i].from[0] + 1, cols_real, blocks + (size_t) displs[i + 1] * BLOCK_UNIT);
+    }
+    MPI_Scatterv(blocks, counts, displs, unit_type, NULL, 0, unit_type, 0, comm);
+
+    run_reductions(&control, jobs, job_cnt);
+
+    MPI_Gatherv(NULL, 0, unit_type, blocks, counts, displs, unit_type, 0, comm);
+    for(int i = 0; i < job_cnt; i++) {
+        wire_decode_rows(control.wire, blocks + (size_t) displs[i + 1] * BLOCK_UNIT, jobs[i].to[1] - jobs[i].from[1] + 1, jobs[i].to[0] - jobs[i].from[0] + 1, cols_real, buffer + (size_t) jobs[i].from[1] * cols_real + jobs[i].from[0], CELL_ALIVE);
+    }
+    if(control.wire != WIRE_RAW) {
+        // Only the alive bits came back
+        if(torus) {
+            wrap_ring(buffer, rows_real, cols_real);
+        }
+        updater(buffer, rows_real, cols_real);
+        if(torus) {
+            clear_ring(buffer, rows_real, cols_real);
+        }
+    }
+    tend = MPI_Wtime();
+
+    #ifdef DEBUG
+    printf("Generation %d:\n\n", run_gens);
+    mprint_binc(buffer, rows_real, cols_real, 'X', '.');
+    printf("\n---\t---\t---\n\n");
+    #endif
+
+    reduce_allocs();
+
+    return tend - tstart;
+}
+
+
+// Parallel version 1 - 1D data decomposition. Returns the elapsed time
+float run_parallel_1d(uint8_t* buffer) {
+    jobs_1d = create_jobs_1d(rows, columns, worker_cnt, &job_1d_cnt);
+    // print_areas(jobs_1d, job_1d_cnt);
+
+    float elapsed = run_blocks(buffer, MODE_1D, jobs_1d, job_1d_cnt);
+
+    free(jobs_1d);
+    return elapsed;
+}
+
+
+// Parallel version 2 - 2D data decomposition. Returns the elapsed time
+float run_parallel_2d(uint8_t* buffer) {
+    jobs_2d = create_jobs_2d(rows, columns, worker_cnt, &job_2d_cnt, &job_2d_width);
+    // print_areas(jobs_2d, job_2d_cnt);
+
+    float elapsed = run_blocks(buffer, MODE_2D, jobs_2d, job_2d_cnt);
+
+    free(jobs_2d);
+    return elapsed;
+}
+
+
+// Times each of the `shape_cnt` shapes on `tune_gens` generations of `buffer`, which is restored afterwards (NULL for a drawn universe). Returns the index of the fastest
+int tune_calibrate(uint8_t* buffer, tune_shape_t* shapes, int shape_cnt) {
+    int saved_gens = generations, saved_hash = use_hash;
+    int saved_stats = use_stats, saved_map = map_side, saved_regions = region_cnt;
+    generations = tune_gens;
+    // Only timed, nothing of these runs is written
+    use_hash = use_stats = map_side = region_cnt = 0;
+
+    int best = 0;
+    float tbest = -1;
+    for(int i = 0; i < shape_cnt; i++) {
+        tune_x = shapes[i].workers_x;
+        tune_y = shapes[i].workers_y;
+
+        int job_cnt = -1;
+        area_t* jobs = create_jobs_grid(rows, columns, tune_x, tune_y, &job_cnt);
+        float elapsed = run_blocks(buffer, MODE_AUTO, jobs, job_cnt);
+        free(jobs);
+        if(buffer) {
+            memcpy(buffer, initial_buffer, (size_t) rows_real * cols_real * sizeof(uint8_t));
+        }
+
+        printf("* Calibration of %d x %d blocks: %f [s] (modeled cost %.0f)\n", tune_x, tune_y, elapsed, shapes[i].cost);
+        if(tbest < 0 || elapsed < tbest) {
+            tbest = elapsed;
+            best = i;
+        }
+    }
+
+    generations = saved_gens;
+    use_hash = saved_hash;
+    use_stats = saved_stats;
+    map_side = saved_map;
+    region_cnt = saved_regions;
+    return best;
+}
+
+
+// Parallel version 3 - the decomposition of the tuning file, or else of the cost model (timed first if `tune_gens`), which then goes to the tuning file. Returns the elapsed time
+float run_parallel_auto(uint8_t* buffer) {
+    const char* source = "tuning file";
+    if(!fload_tuning(tune_file, rows, columns, comm_size, &tune_x, &tune_y) || tune_x * tune_y > worker_cnt) {
+        tune_shape_t shapes[TUNE_CANDIDATES];
+        int shape_cnt = tune_shapes(rows, columns, worker_cnt, torus, shapes, TUNE_CANDIDATES);
+        int best = 0;
+        source = "cost model";
+
+        // Streamed runs write their output, so they cannot be repeated just to be timed. Drawn universes are drawn again
+        if(tune_gens > 0 && (buffer || (gen_width > 0 && !stream)) && shape_cnt > 1) {
+            best = tune_calibrate(buffer, shapes, shape_cnt);
+            source = "calibration";
+        }
+
+        tune_x = shapes[best].workers_x;
+        tune_y = shapes[best].workers_y;
+        fwrite_tuning(tune_file, rows, columns, comm_size, tune_x, tune_y);
+    }
+
+    printf("* Decomposition: %d x %d blocks, %d of %d workers (%s)\n", tune_x, tune_y, tune_x * tune_y, worker_cnt, source);
+    fflush(stdout);
+
+    int job_cnt = -1;
+    area_t* jobs = create_jobs_grid(rows, columns, tune_x, tune_y, &job_cnt);
+    float elapsed = run_blocks(buffer, MODE_AUTO, jobs, job_cnt);
+
+    free(jobs);
+    return elapsed;
+}
+
+
+// Works on this worker's block for the run described by `control`. Counts the heap allocations of the arena into `allocs`
+void worker_run(control_t* control, arena_t* arena, int* allocs) {
+    // Same decomposition as the master, so nobody has to be told where its block is
+    int job_cnt = -1, workers_x = 1;
+    area_t* jobs = NULL;
+    if(control->mode == MODE_AUTO) {
+        workers_x = control->workers_x;
+        jobs = create_jobs_grid(control->rows, control->columns, control->workers_x, control->workers_y, &job_cnt);
+    }
+    else if(control->mode == MODE_2D) {
+        jobs = create_jobs_2d(control->rows, control->columns, worker_cnt, &job_cnt, &workers_x);
+    }
+    else {
+        jobs = create_jobs_1d(control->rows, control->columns, worker_cnt, &job_cnt);
+    }
+
+    int job = rank - 1;
+    int active = job < job_cnt;
+    int block_rows = active ? jobs[job].to[1] - jobs[job].from[1] + 1 : 0;
+    int block_cols = active ? jobs[job].to[0] - jobs[job].from[0] + 1 : 0;
+    int block_units = BLOCK_UNITS(WIRE_ROWS_SIZE(control->wire, block_rows, block_cols));
+    // Generations per halo exchange, the same for every block so that neighbours exchange together
+    int depth = block_depth(jobs, job_cnt, control->tile, control->time_block, control->halo);
+
+    // The block, and the hash deltas and statistics of the generations since the last reduction
+    int batch_size = control->use_hash ? control->cycle_check : 0;
+    int stats_size = control->use_stats ? control->cycle_check : 0;
+    // The density map only covers the blocks of the map this block crosses, the master adds up those across two blocks
+    size_t map_size = control->map_side > 0 && active ? DMAP_PART_BLOCKS(jobs[job].from, jobs[job].to, control->map_side) * sizeof(uint32_t) : 0;
+    arena_reset(arena, (active ? BLOCK_ARENA_SIZE(block_rows, block_cols, depth, depth > 1 ? control->tile : 0) : 0) + 2 * ARENA_SIZE(batch_size * sizeof(uint64_t)) + ARENA_SIZE(stats_size * sizeof(gen_stats_t)) + ARENA_SIZE(map_size));
+    uint64_t* hash_deltas = arena_alloc(arena, batch_size * sizeof(uint64_t));
+    uint64_t* hash_reduced = arena_alloc(arena, batch_size * sizeof(uint64_t));
+    gen_stats_t* stats = arena_alloc(arena, stats_size * sizeof(gen_stats_t));
+    dmap_t map = {0};
+    if(control->map_side > 0 && active) {
+        dmap_init_part(&map, control->rows, control->columns, control->map_side, jobs[job].from, jobs[job].to, arena_alloc(arena, map_size));
+    }
+    int hash_pending = 0, stats_pending = 0;
+
+    block_t block;
+    if(active) {
+        block_init(&block, arena, jobs[job], job, job_cnt, workers_x, control->torus, depth, control->tile, control->halo, control->wire);
 
-        done:
         if(_ldebug) {
-            printf("[%d]: Exited execution loop\n", rank);
+            printf("[%d]: Block of %d x %d at (%d, %d)\n", rank, block_rows, block_cols, block.origin[0], block.origin[1]);
             fflush(stdout);
         }
     }
 
-    final_mpi:
+    block_open(active ? &block : NULL, comm, control->halo);
+
+    if(control->generate) {
+        // Cells only depend on their position, so the block and its ring (the opposite edges of a torus included) are drawn here
+        if(active) {
+            int ring_origin[] = {block.origin[0] - block.ring[2], block.origin[1] - block.ring[0]};
+            rgen_area(block.cells, block.rows_real, block.cols_real, ring_origin, control->rows, control->columns, control->density, control->seed, control->torus);
+        }
+
+        // The master has no copy to hash, see `reduce_drawn_hash()`
+        if(control->use_hash) {
+            uint64_t hash = 0;
+            for(int i = 0; active && i < block_rows; i++) {
+                int row_origin[] = {block.origin[0], block.origin[1] + i};
+                hash ^= ghash(BLOCK_FIRST(&block) + (size_t) i * block.cols_real, 1, block_cols, row_origin);
+            }
+            MPI_Reduce(&hash, NULL, 1, MPI_UINT64_T, MPI_BXOR, 0, comm);
+        }
+    }
+    else if(control->stream) {
+        // Streamed bands only carry the alive bits
+        if(active) {
+            stream_recv(&block, control->stream, comm);
+            block_refresh(&block, comm);
+        }
+    }
+    else {
+        MPI_Scatterv(NULL, NULL, NULL, unit_type, active ? block.packed : NULL, block_units, unit_type, 0, comm);
+        if(active) {
+            wire_decode_rows(control->wire, block.packed, block_rows, block_cols, block.cols_real, BLOCK_FIRST(&block), CELL_ALIVE);
+            if(control->wire != WIRE_RAW) {
+                block_refresh(&block, comm);
+            }
+        }
+    }
+    allocs[0] += arena_count(arena);
+
+    int gen = 0;
+    int stop = 0;
+    while(gen < control->generations && !stop) {
+        // Tiled blocks take up to `depth` generations per step, which end where the master needs them whole (regions) or reduces a batch, with at most one frame of the map among them (see `until_output(...)`)
+        int steps = MIN(depth, control->generations - gen);
+        if(control->use_hash || control->use_stats) {
+            steps = MIN(steps, control->cycle_check - gen % control->cycle_check);
+        }
+        if(control->map_side > 0) {
+            steps = MIN(steps, 2 * control->map_every - 1 - gen % control->map_every);
+        }
+        if(control->region_cnt > 0 && control->region_every > 0) {
+            steps = MIN(steps, control->region_every - gen % control->region_every);
+        }
+        int frame = control->map_side > 0 ? control->map_every - gen % control->map_every : 0;
+        if(frame > steps) {
+            frame = 0;
+        }
+
+        for(int step = 0; control->use_stats && step < steps; step++) {
+            stats_clear(&stats[stats_pending + step]);
+        }
+        if(control->use_hash) {
+            memset(hash_deltas + hash_pending, 0, steps * sizeof(uint64_t));
+        }
+        if(frame && active) {
+            dmap_clear(&map);
+        }
+
+        if(active) {
+            block_step(&block, comm, steps, control->use_hash ? hash_deltas + hash_pending : NULL, control->use_stats ? stats + stats_pending : NULL, frame ? &map : NULL, frame);
+        }
+        if(control->use_hash) {
+            hash_pending += steps;
+        }
+        if(control->use_stats) {
+            stats_pending += steps;
+        }
+
+        // Then the generations of the step one by one, in the order of `run_reductions(...)`
+        for(int step = 0; step < steps && !stop; step++) {
+            gen++;
+
+            if(frame == step + 1) {
+                MPI_Gatherv(map.counts, map.map_rows * map.map_cols, MPI_UINT32_T, NULL, NULL, NULL, MPI_UINT32_T, 0, comm);
+            }
+            int regions_due = control->region_cnt > 0 && control->region_every > 0 && gen % control->region_every == 0;
+            for(int k = 0; regions_due && active && k < control->region_cnt; k++) {
+                region_send(&block, &control->regions[k], comm);
+            }
+
+            // One reduction of the hashes and one of the statistics per batch
+            if((control->use_hash || control->use_stats) && (gen % control->cycle_check == 0 || gen == control->generations)) {
+                if(control->use_hash) {
+                    MPI_Allreduce(hash_deltas, hash_reduced, hash_pending, MPI_UINT64_T, MPI_BXOR, comm);
+                    hash_pending = 0;
+                }
+                if(control->use_stats) {
+                    MPI_Reduce(stats, NULL, stats_pending, stats_type, stats_op, 0, comm);
+                    stats_pending = 0;
+                }
+
+                if(control->stop_early) {
+                    MPI_Bcast(&stop, 1, MPI_INT, 0, comm);
+                }
+            }
+        }
+    }
+
+    // The regions after the last generation, unless they just went
+    int regions_sent = control->region_every > 0 && gen > 0 && gen % control->region_every == 0;
+    for(int k = 0; !regions_sent && active && k < control->region_cnt; k++) {
+        region_send(&block, &control->regions[k], comm);
+    }
+    allocs[1] += arena_count(arena);
+
+    if(control->stream) {
+        MPI_Barrier(comm);
+        if(active) {
+            stream_send(&block, control->stream, comm);
+        }
+    }
+    else if(control->generate) {
+        // Drawn blocks are not gathered
+        MPI_Barrier(comm);
+    }
+    else {
+        if(active) {
+            wire_encode_rows(control->wire, BLOCK_FIRST(&block), block_rows, block_cols, block.cols_real, block.packed);
+        }
+        MPI_Gatherv(active ? block.packed : NULL, block_units, unit_type, NULL, NULL, NULL, unit_type, 0, comm);
+    }
+
+    block_close(active ? &block : NULL);
+
+    free(jobs);
+}
+
+
+// Serves the master of `comm` until it sends `CONTROL_DONE`
+void worker_loop() {
+    control_t control;
+
+    // Every buffer of every run comes from here
+    arena_t* arena = arena_create(0);
+    int allocs[2] = {0, 0};
+
+    while(true) {
+        MPI_Bcast(&control, 1, control_type, 0, comm);
+
+        if(control.mode == CONTROL_STATS) {
+            // End of a run
+            MPI_Reduce(allocs, NULL, 2, MPI_INT, MPI_SUM, 0, comm);
+            allocs[0] = allocs[1] = 0;
+        }
+        else if(control.mode == CONTROL_DONE) {
+            if(_ldebug) {
+                printf("DONE! - [%d]\n", rank);
+                fflush(stdout);
+            }
+            break;
+        }
+        else {
+            if(_ldebug) {
+                printf("Parallel mode %s - [%d]\n", control.mode == MODE_2D ? "2d" : "1d", rank);
+                fflush(stdout);
+            }
+
+            worker_run(&control, arena, allocs);
+        }
+    }
+
+    arena_free(arena);
+
+    if(_ldebug) {
+        printf("[%d]: Exited execution loop\n", rank);
+        fflush(stdout);
+    }
+}
+
+
+typedef struct _version_t {
+    int mode;
+    char* title;
+    char* name;
+    char* out_type;
+    int min_workers;
+    float (*run)(uint8_t* buffer);
+} version_t;
+
+version_t versions[] = {
+    {MODE_SERIAL, "SERIAL VERSION", "serial", "serial", 0, run_serial},
+    {MODE_1D, "PARALLEL VERSION - 1D", "1D parallel", "parallel1d", MINIMUM_1D, run_parallel_1d},
+    {MODE_2D, "PARALLEL VERSION - 2D", "2D parallel", "parallel2d", MINIMUM_2D, run_parallel_2d},
+    {MODE_AUTO, "PARALLEL VERSION - AUTO", "auto parallel", "parallelauto", 1, run_parallel_auto},
+    {MODE_THREADS, "THREADED VERSION", "threaded", "threaded", 0, run_threaded},
+    {MODE_OOC, "OUT-OF-CORE VERSION", "out-of-core", "outofcore", 0, run_out_of_core},
+};
+
+
+// Writes the statistics of the last run next to the output of the version, as `<input>_<type>_stats.csv`
+void write_stats(char* out_type) {
+    char* stats_path = get_side_path(out_type, "stats", "csv");
+
+    fwrite_stats(stats_path, run_stats, run_gens);
+    printf("* Statistics: %s\n\n", stats_path);
+    fflush(stdout);
+    free(stats_path);
+}
+
+
+// Runs a version `repetitions` times from the initial generation, then checks and writes the result of the last run
+// Returns the best time (the mean is left in `tmean`), or -1 if the version could not run
+float run_version(version_t* version) {
+    if(worker_cnt < version->min_workers) {
+        printf("At least %d workers needed for the %s version. Got %d\n", version->min_workers, version->name, worker_cnt); fflush(stdout);
+        return -1;
+    }
+
+    if(sweep_cnt > 0 && version->min_workers > 0) {
+        printf("\n\n-------\t%s (%d workers)\t-------\n\n", version->title, worker_cnt);
+    }
+    else {
+        printf("\n\n-------\t%s\t-------\n\n", version->title);
+    }
+    fflush(stdout);
+
+    #ifdef DEBUG
+    if(initial_buffer) {
+        printf("Initial generation:\n\n");
+        mprint_binc(initial_buffer, rows_real, cols_real, 'X', '.');
+        printf("\n---\t---\t---\n\n");
+    }
+    #endif
+
+    // Runs without the universe in memory (streamed, out of core) write their output themselves, drawn ones only if streamed
+    if(!initial_buffer) {
+        output_path = get_output_path(input_path, version->out_type);
+    }
+
+    run_type = version->out_type;
+
+    // Frames of the density map go next to the output, each repetition writing them again
+    char* map_path = NULL;
+    if(map_side > 0) {
+        map_path = map_out ? strdup(map_out) : get_side_path(version->out_type, "density", "pgm");
+        if(!map_out) {
+            char dir_path[strlen(map_path) + 1];
+            strcpy(dir_path, map_path);
+            validate_path(dir_path);
+        }
+    }
+
+    float tbest = -1, tsum = 0;
+    for(int rep = 0; rep < repetitions; rep++) {
+        if(initial_buffer) {
+            memcpy(work_buffer, initial_buffer, (size_t) rows_real * cols_real * sizeof(uint8_t));
+        }
+        if(map_path) {
+            // A named pipe blocks here until its reader opens it, outside of the timing
+            run_map_file = fopen(map_path, "wb");
+            if(!run_map_file) {
+                perror("Error while opening density map");
+                exit(errno);
+            }
+        }
+
+        telapsed = version->run(work_buffer);
+
+        if(map_path) {
+            fclose(run_map_file);
+            run_map_file = NULL;
+        }
+
+        if(repetitions > 1) {
+            printf("* Repetition %d: %f [s]\n", rep + 1, telapsed);
+            fflush(stdout);
+        }
+        tsum += telapsed;
+        if(tbest < 0 || telapsed < tbest) tbest = telapsed;
+    }
+
+    // The best repetition is the one reported and written
+    telapsed = tbest;
+    tmean = tsum / repetitions;
+    printf("End result:\n");
+    printf("* Time elapsed: %f [s]\n", telapsed);
+    if(repetitions > 1) {
+        printf("* Mean time: %f [s] (%d repetitions)\n", tsum / repetitions, repetitions);
+    }
+    if(version->mode != MODE_SERIAL && reference_time > 0) {
+        printf("* Speedup: %f\n", reference_time / telapsed);
+    }
+    printf("* Heap allocations: %d up to the first generation, %d after it\n", run_allocs[0], run_allocs[1]);
+    cycle_report(run_cycle, run_gens);
+    printf("\n");
+    #ifdef DEBUG
+    if(work_buffer) {
+        mprint_binc(work_buffer, rows_real, cols_real, 'X', '.');
+    }
+    #endif
+    printf("\n---\t---\t---\n\n");
+
+    if(version->mode == MODE_SERIAL) {
+        // Becomes the reference of the parallel versions
+        mem_free(reference_buffer);
+        reference_buffer = get_chunk(work_buffer, rows_real, cols_real, init_from, init_to);
+        reference_time = telapsed;
+    }
+    else if(reference_buffer) {
+        int is_correct = mequal(reference_buffer, work_buffer, rows_real, cols_real);
+
+        printf("Is the %s version equal to the serial version?\n", version->name);
+        if(is_correct) {
+            printf("\tYES\n\t\t:)\n");
+        }
+        else {
+            printf("\tNO\n\t\t:(\n");
+        }
+        printf("\n---\t---\t---\n\n");
+        fflush(stdout);
+    }
+
+    // The out of core version runs alone, and is as much a reference as the serial one. Drawn universes only run in parallel, so those record theirs
+    verify_golden(version->name, run_hash, run_gens, (version->mode & (MODE_SERIAL | MODE_OOC)) || gen_width > 0);
+
+    if(use_stats) {
+        write_stats(version->out_type);
+    }
+    if(map_path) {
+        printf("* Density map: %s (%d frames of %d x %d)\n\n", map_path, run_map_frames, run_map.map_cols, run_map.map_rows);
+        fflush(stdout);
+        free(map_path);
+    }
+    if(region_cnt > 0) {
+        printf("* Regions of interest: %d files, `*_%s_roi*.txt` next to the output\n\n", run_region_files, version->out_type);
+        fflush(stdout);
+    }
+
+    if(!initial_buffer) {
+        free(output_path);
+    }
+    // Sweeps only keep the times of the parallel versions
+    else if(sweep_cnt == 0 || version->mode == MODE_SERIAL) {
+        output_path = get_output_path(input_path, version->out_type);
+        fwrite_gen(output_path, work_buffer, rows_real, cols_real, telapsed);
+        free(output_path);
+    }
+
+    return telapsed;
+}
+
+
+typedef struct _sweep_row_t {
+    int workers;
+    version_t* version;
+    float tbest;
+    float tmean;
+} sweep_row_t;
+
+sweep_row_t* sweep_rows = NULL;
+int sweep_row_cnt = 0;
+
+
+void sweep_record(version_t* version, float tbest) {
+    sweep_rows = realloc(sweep_rows, (sweep_row_cnt + 1) * sizeof(sweep_row_t));
+    if(!sweep_rows) {
+        perror("Error allocating sweep results");
+        exit(errno);
+    }
+
+    sweep_rows[sweep_row_cnt++] = (sweep_row_t) {
+        workers: version->mode == MODE_SERIAL ? 0 : worker_cnt,
+        version: version,
+        tbest: tbest,
+        tmean: tmean
+    };
+}
+
+
+// Writes all the times of the sweep, with their speedup against the serial reference (-1 if there is none)
+void fwrite_sweep(char* out_file_name) {
+    char file_path[strlen(out_file_name) + 1];
+    strcpy(file_path, out_file_name);
+    validate_path(file_path);
+
+    FILE* out_file = fopen(out_file_name, "w");
+    if(!out_file) {
+        perror("Error opening sweep output file");
+        exit(errno);
+    }
+
+    char* ext = strrchr(out_file_name, '.');
+    int json = ext && strcmp(ext, ".json") == 0;
+
+    if(json) {
+        fprintf(out_file, "{\n  \"input\": \"%s\",\n  \"rows\": %d,\n  \"columns\": %d,\n  \"generations\": %d,\n  \"repetitions\": %d,\n  \"runs\": [\n",
+            golden_key, rows, columns, generations, repetitions);
+    }
+    else {
+        fprintf(out_file, "input,rows,columns,generations,workers,version,time,mean_time,speedup\n");
+    }
+
+    for(int i = 0; i < sweep_row_cnt; i++) {
+        sweep_row_t* row = &sweep_rows[i];
+        float speedup = reference_time > 0 ? reference_time / row->tbest : -1;
+
+        if(json) {
+            fprintf(out_file, "    {\"workers\": %d, \"version\": \"%s\", \"time\": %f, \"mean_time\": %f, \"speedup\": %f}%s\n",
+                row->workers, row->version->out_type, row->tbest, row->tmean, speedup, i + 1 < sweep_row_cnt ? "," : "");
+        }
+        else {
+            fprintf(out_file, "%s,%d,%d,%d,%d,%s,%f,%f,%f\n",
+                golden_key, rows, columns, generations, row->workers, row->version->out_type, row->tbest, row->tmean, speedup);
+        }
+    }
+
+    if(json) {
+        fprintf(out_file, "  ]\n}\n");
+    }
+
+    fclose(out_file);
+}
+
+
+// Runs the selected versions with the processes of `config_comm`: its rank 0 is the master, the rest are workers
+void run_config(MPI_Comm config_comm, int modes) {
+    comm = config_comm;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &comm_size);
+    worker_cnt = comm_size - 1;
+
+    if(rank != 0) {
+        worker_loop();
+        return;
+    }
+
+    for(int i = 0; i < (int) (sizeof(versions) / sizeof(version_t)); i++) {
+        if(modes & versions[i].mode) {
+            float tbest = run_version(&versions[i]);
+            if(sweep_cnt > 0 && tbest >= 0) {
+                sweep_record(&versions[i], tbest);
+            }
+        }
+    }
+
+    send_control(CONTROL_DONE);
+}
+
+
+// Result of one universe of a batch
+typedef struct _batch_result_t {
+    int rows, columns;
+    int gens; // generations run, fewer than asked if the universe stopped early
+    int worker;
+    long long population;
+    uint64_t hash;
+    double time;
+} batch_result_t;
+
+
+// Gives the neighbour data of a freshly loaded universe the boundaries in use
+void prepare_universe(uint8_t* buffer) {
+    // The loaders give the edge cells dead neighbours beyond the edge, a torus has the opposite edge there
+    if(torus) {
+        wrap_ring(buffer, rows_real, cols_real);
+        updater(buffer, rows_real, cols_real);
+        clear_ring(buffer, rows_real, cols_real);
+    }
+}
+
+
+// Loads one universe of a batch, runs it with the serial version and writes its final generation
+void batch_run(char* path, batch_result_t* result) {
+    uint8_t* buffer = fload_gen(path, &rows, &columns);
+    rows_real = rows + 2;
+    cols_real = columns + 2;
+    init_to[0] = cols_real - 1; init_to[1] = rows_real - 1;
+
+    prepare_universe(buffer);
+
+    result->time = run_serial(buffer);
+    result->rows = rows;
+    result->columns = columns;
+    result->gens = run_gens;
+    result->worker = world_rank;
+    result->population = population(buffer, rows_real, cols_real);
+    result->hash = ghash(buffer, rows_real, cols_real, init_from);
+
+    output_path = get_output_path(path, "batch");
+    fwrite_gen(output_path, buffer, rows_real, cols_real, result->time);
+    free(output_path);
+
+    mem_free(buffer);
+}
+
+
+// Ensemble mode: whole universes go to the workers through a work queue, each worker asks for the next one when it is done
+void run_batch() {
+    init_from[0] = 0; init_from[1] = 0;
+    master_arena = arena_create(0);
+
+    if(world_rank != 0) {
+        char path[IN_CHUNK];
+        batch_result_t result;
+        MPI_Status status;
+
+        while(1) {
+            int job = -1;
+            MPI_Recv(&job, 1, MPI_INT, 0, MPI_ANY_TAG, MPI_COMM_WORLD, &status);
+            if(status.MPI_TAG == DONE_TAG) break;
+
+            MPI_Recv(path, IN_CHUNK, MPI_CHAR, 0, HEADER_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+            batch_run(path, &result);
+
+            MPI_Send(&job, 1, MPI_INT, 0, BATCH_TAG, MPI_COMM_WORLD);
+            MPI_Send(&result, sizeof(batch_result_t), MPI_BYTE, 0, DATA_TAG, MPI_COMM_WORLD);
+        }
+
+        arena_free(master_arena);
+        return;
+    }
+
+    int batch_cnt = 0;
+    char** paths = fload_manifest(batch_path, &batch_cnt);
+    batch_result_t* results = calloc(batch_cnt + 1, sizeof(batch_result_t));
+    if(!results) {
+        perror("Error allocating batch results");
+        exit(errno);
+    }
+
+    printf("Batch of %d universes, %d generations each\n", batch_cnt, generations);
+    fflush(stdout);
+
+    // `tstart` and `tend` belong to the serial runs
+    double tbatch = MPI_Wtime();
+    int next = 0, done = 0;
+
+    if(worker_cnt == 0) {
+        // Nobody to hand the universes to
+        for(; next < batch_cnt; next++) {
+            batch_run(paths[next], &results[next]);
+        }
+        done = batch_cnt;
+    }
+
+    // One universe per worker to start with, then one more for each result that comes back
+    for(int i = 0; i < worker_cnt; i++) {
+        if(next < batch_cnt) {
+            MPI_Send(&next, 1, MPI_INT, i + 1, BATCH_TAG, MPI_COMM_WORLD);
+            MPI_Send(paths[next], strlen(paths[next]) + 1, MPI_CHAR, i + 1, HEADER_TAG, MPI_COMM_WORLD);
+            next++;
+        }
+    }
+
+    while(done < batch_cnt) {
+        int job = -1;
+        MPI_Status status;
+        MPI_Recv(&job, 1, MPI_INT, MPI_ANY_SOURCE, BATCH_TAG, MPI_COMM_WORLD, &status);
+        MPI_Recv(&results[job], sizeof(batch_result_t), MPI_BYTE, status.MPI_SOURCE, DATA_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+        done++;
+
+        if(next < batch_cnt) {
+            MPI_Send(&next, 1, MPI_INT, status.MPI_SOURCE, BATCH_TAG, MPI_COMM_WORLD);
+            MPI_Send(paths[next], strlen(paths[next]) + 1, MPI_CHAR, status.MPI_SOURCE, HEADER_TAG, MPI_COMM_WORLD);
+            next++;
+        }
+    }
+    tbatch = MPI_Wtime() - tbatch;
+
+    for(int i = 0; i < worker_cnt; i++) {
+        MPI_Send(&worker_cnt, 1, MPI_INT, i + 1, DONE_TAG, MPI_COMM_WORLD);
+    }
+
+    FILE* out_file = fopen(batch_out, "w");
+    if(!out_file) {
+        perror("Error opening batch results file");
+        exit(errno);
+    }
+    fprintf(out_file, "input,rows,columns,generations,population,hash,time,worker\n");
+    for(int i = 0; i < batch_cnt; i++) {
+        fprintf(out_file, "%s,%d,%d,%d,%lld,%016llx,%f,%d\n", paths[i], results[i].rows, results[i].columns, results[i].gens,
+            results[i].population, (unsigned long long) results[i].hash, results[i].time, results[i].worker);
+    }
+    fclose(out_file);
+
+    printf("* Time elapsed: %f [s]\n", tbatch);
+    printf("* Throughput: %f grids/s (%d workers)\n", batch_cnt / tbatch, MAX(worker_cnt, 1));
+    printf("Batch results written to %s\n", batch_out);
+    fflush(stdout);
+
+    for(int i = 0; i < batch_cnt; i++) {
+        free(paths[i]);
+    }
+    free(paths);
+    free(results);
+    arena_free(master_arena);
+}
+
+
+// Prints how the buffers are backed and on which NUMA node every process of the world runs
+void report_placement() {
+    int where[2];
+    mem_where(&where[0], &where[1]);
+
+    int* all = NULL;
+    if(world_rank == 0) {
+        all = calloc(2 * comm_size, sizeof(int));
+        if(!all) {
+            perror("Error allocating placement report");
+            exit(errno);
+        }
+    }
+
+    MPI_Gather(where, 2, MPI_INT, all, 2, MPI_INT, 0, MPI_COMM_WORLD);
+
+    if(world_rank == 0) {
+        const char* requested[] = {"none", "transparent", "explicit"};
+        printf("Memory placement:\n");
+        printf("* Huge pages requested for buffers of %d MB or more: %s\n", MEM_LARGE >> 20, requested[mem_get_pages()]);
+        if(initial_buffer) {
+            printf("* Grid buffer (%d x %d): %s, first touched by the master\n", rows_real, cols_real, mem_backing(initial_buffer));
+        }
+        else if(ooc_dir) {
+            printf("* Grid buffer: none, memory mapped files in %s, solved in bands of %d rows\n", ooc_dir, OOC_BAND_ROWS(columns));
+        }
+        else if(gen_width > 0 && !stream) {
+            printf("* Grid buffer: none, drawn block by block by the workers and never gathered\n");
+        }
+        else {
+            printf("* Grid buffer: none, streamed in bands of %d rows\n", STREAM_BAND_ROWS(columns));
+        }
+        printf("* Worker blocks: arenas first touched by their own worker\n");
+
+        // Processes per NUMA node
+        int max_node = -1;
+        for(int i = 0; i < comm_size; i++) {
+            max_node = MAX(max_node, all[2 * i + 1]);
+        }
+        if(max_node < 0) {
+            printf("* NUMA node of the processes unknown\n");
+        }
+        for(int node = 0; node <= max_node; node++) {
+            int cnt = 0;
+            for(int i = 0; i < comm_size; i++) {
+                cnt += all[2 * i + 1] == node;
+            }
+            printf("* Node %d: %d processes%s\n", node, cnt, where[1] == node ? " (master included)" : "");
+        }
+        printf("\n");
+        fflush(stdout);
+    }
+
+    free(all);
+}
+
+
+int main(int argc, char** argv) {
+    MPI_Init(&argc, &argv);
+
+    MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
+
+    MPI_Comm_size(MPI_COMM_WORLD, &comm_size);
+    worker_cnt = comm_size - 1;
+
+    // Every process reads the options, only the master complains about them
+    int args_err = parse_args(argc, argv, world_rank == 0);
+    create_types();
+
+    // Main Process
+    if(world_rank == 0 && args_err != 0) {
+        usage(argv[0]);
+        MPI_Abort(MPI_COMM_WORLD, 0);
+    }
+
+    if(batch_path) {
+        if(world_rank == 0) {
+            const rule_t* rule = rule_get();
+            printf("Rule: %s, %s neighbourhood, %s kernel\n", rule->name, rule->neighbourhood == RULE_MOORE ? "Moore" : "von Neumann", rule->compiled ? "compiled" : "generic");
+            fflush(stdout);
+        }
+
+        run_batch();
+
+        free_types();
+        MPI_Finalize();
+        return 0;
+    }
+
+    if(world_rank == 0) {
+        if(gen_width > 0) {
+            // Synthetic universe, no file I/O involved: the workers draw their own blocks, the master holds none of it
+            rows = gen_height;
+            columns = gen_width;
+        }
+        else if(stream || ooc_dir) {
+            // Only the dimensions, every run streams the rows again
+            fclose(fopen_gen(input_path, &rows, &columns));
+        }
+        else {
+            initial_buffer = fload_gen(input_path, &rows, &columns);
+        }
+
+        rows_real = rows + 2;
+        cols_real = columns + 2;
+
+        init_from[0] = 0; init_from[1] = 0;
+        init_to[0] = cols_real - 1; init_to[1] = rows_real - 1;
+
+        if(initial_buffer) {
+            prepare_universe(initial_buffer);
+            work_buffer = get_chunk(initial_buffer, rows_real, cols_real, init_from, init_to);
+        }
+        master_arena = arena_create(0);
+
+        // Regions have to lie inside the universe. The master receives the parts of the workers in one buffer, the size of the largest
+        size_t region_size = 0;
+        for(int k = 0; k < region_cnt; k++) {
+            if(regions[k].to[0] > columns || regions[k].to[1] > rows) {
+                printf("Region %d (%d x %d from column %d, row %d) leaves the %d x %d universe\n", k,
+                    regions[k].to[0] - regions[k].from[0] + 1, regions[k].to[1] - regions[k].from[1] + 1, regions[k].from[0] - 1, regions[k].from[1] - 1, columns, rows);
+                fflush(stdout);
+                exit(-1);
+            }
+            region_size = MAX(region_size, (size_t) (regions[k].to[0] - regions[k].from[0] + 1) * (regions[k].to[1] - regions[k].from[1] + 1));
+        }
+        if(region_cnt > 0) {
+            run_region = malloc(region_size * sizeof(uint8_t));
+            if(!run_region) {
+                perror("Error allocating region buffer");
+                exit(errno);
+            }
+        }
+
+        // A cached serial result replaces the serial run as reference
+        if(reference_path && !(run_modes & MODE_SERIAL)) {
+            reference_buffer = fload_result(reference_path, rows_real, cols_real, &reference_time);
+            printf("Loaded the serial reference from %s (%f [s])\n", reference_path, reference_time);
+            fflush(stdout);
+        }
+    }
+
+    report_placement();
+
+    if(world_rank == 0) {
+        const rule_t* rule = rule_get();
+        printf("Rule: %s, %s neighbourhood, %s kernel\n\n", rule->name, rule->neighbourhood == RULE_MOORE ? "Moore" : "von Neumann", rule->compiled ? "compiled" : "generic");
+        fflush(stdout);
+    }
+
+    if(sweep_cnt > 0) {
+        // The serial baseline and the threaded version only need the master
+        if(world_rank == 0 && (run_modes & (MODE_SERIAL | MODE_THREADS))) {
+            run_config(MPI_COMM_SELF, run_modes & (MODE_SERIAL | MODE_THREADS));
+        }
+
+        // One launch, one already loaded universe: each worker count gets the first ranks of the world
+        for(int i = 0; i < sweep_cnt; i++) {
+            MPI_Comm sub_comm;
+            MPI_Comm_split(MPI_COMM_WORLD, world_rank <= sweep_counts[i] ? 0 : MPI_UNDEFINED, world_rank, &sub_comm);
+
+            if(sub_comm != MPI_COMM_NULL) {
+                run_config(sub_comm, run_modes & ~(MODE_SERIAL | MODE_THREADS));
+                MPI_Comm_free(&sub_comm);
+            }
+        }
+
+        if(world_rank == 0) {
+            fwrite_sweep(sweep_out);
+            printf("Sweep results written to %s\n", sweep_out);
+            fflush(stdout);
+        }
+    }
+    else {
+        run_config(MPI_COMM_WORLD, run_modes);
+    }
+
+
+    // -- Clean-up the workspace --
+    if(world_rank == 0) {
+        cycle_free(run_cycle);
+        free(run_stats);
+        free(run_map.counts);
+        free(run_region);
+        mem_free(initial_buffer);
+        mem_free(work_buffer);
+        mem_free(reference_buffer);
+        free(sweep_rows);
+        arena_free(master_arena);
+    }
+    free(sweep_counts);
+    free_types();
+
     MPI_Finalize();
 
     return 0;
-}
\ No newline at end of file
+}